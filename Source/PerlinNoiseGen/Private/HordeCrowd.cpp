@@ -0,0 +1,378 @@
+#include "HordeCrowd.h"
+#include "NoiseTerrainActor.h"
+#include "TerrainSnapshot.h"
+#include "TerrainHorizonOcclusion.h"
+#include "Async/ParallelFor.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "Engine/StaticMesh.h"
+
+namespace
+{
+    // Walks a cell index to the one containing Coord; agents move < 1 cell per step, so this is
+    // usually zero or one step. Large jumps (spawn, teleport) fall back to a floor. The result is
+    // always in [0, MaxCell], whatever Cell came in as (INDEX_NONE for new or reset agents).
+    FORCEINLINE int32 WalkCell(int32 Cell, float Coord, int32 MaxCell)
+    {
+        if (Cell < 0 || Cell > MaxCell || FMath::Abs(Coord - (float)Cell) > 2.f)
+        {
+            return FMath::Clamp(FMath::FloorToInt(Coord), 0, MaxCell);
+        }
+        while (Cell > 0 && Coord < (float)Cell) --Cell;
+        while (Cell < MaxCell && Coord >= (float)(Cell + 1)) ++Cell;
+        return Cell;
+    }
+}
+
+AHordeCrowd::AHordeCrowd()
+{
+    PrimaryActorTick.bCanEverTick = true;
+
+    Instances = CreateDefaultSubobject<UInstancedStaticMeshComponent>(TEXT("Instances"));
+    Instances->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+    Instances->SetCanEverAffectNavigation(false);
+    Instances->SetCastShadow(false);
+    SetRootComponent(Instances);
+}
+
+void AHordeCrowd::OnConstruction(const FTransform& Transform)
+{
+    if (Instances && Instances->GetStaticMesh() != AgentMesh)
+    {
+        Instances->SetStaticMesh(AgentMesh);
+    }
+}
+
+void AHordeCrowd::RefreshCrowdTransform(const FTerrainSnapshot* Ground)
+{
+    CrowdToWorld = Ground ? Ground->ActorTransform : FTransform::Identity;
+}
+
+int32 AHordeCrowd::SpawnAgents(int32 Count, FVector WorldCenter, float Radius, int32 Seed)
+{
+    const FTerrainSnapshotPtr Ground = Terrain ? Terrain->GetSnapshot() : nullptr;
+    RefreshCrowdTransform(Ground.Get());
+
+    const FVector Center = CrowdToWorld.InverseTransformPosition(WorldCenter);
+    return AddAgents(Count, Seed, (float)Center.Z, [&Center, Radius](FRandomStream& RNG)
+    {
+        // Uniform in the disc
+        const float R = Radius * FMath::Sqrt(RNG.FRand());
+        const float A = RNG.FRandRange(0.f, 2.f * PI);
+        return FVector2f((float)Center.X + R * FMath::Cos(A), (float)Center.Y + R * FMath::Sin(A));
+    });
+}
+
+int32 AHordeCrowd::SpawnAgentsInZone(int32 Count, int32 Zone, int32 Seed)
+{
+    if (!Terrain)
+    {
+        UE_LOG(LogTemp, Warning, TEXT("HordeCrowd: SpawnAgentsInZone needs a Terrain."));
+        return INDEX_NONE;
+    }
+
+    // Zone cells are in terrain-local space, the same space the agents live in
+    const FTerrainSpawnZones& Zones = Terrain->GetSpawnZones();
+    if (Zones.GetZoneCellCount(Zone) <= 0)
+    {
+        UE_LOG(LogTemp, Warning, TEXT("HordeCrowd: spawn zone %d of %s has no cells."), Zone, *Terrain->GetName());
+        return INDEX_NONE;
+    }
+
+    return AddAgents(Count, Seed, 0.f, [&Zones, Zone](FRandomStream& RNG)
+    {
+        FVector2f XY;
+        Zones.Draw(Zone, RNG, XY);
+        return XY;
+    });
+}
+
+int32 AHordeCrowd::AddAgents(int32 Count, int32 Seed, float StartZ, TFunctionRef<FVector2f(FRandomStream&)> PickXY)
+{
+    const int32 First = PosX.Num();
+    if (Count <= 0) return First;
+
+    const FTerrainSnapshotPtr Ground = Terrain ? Terrain->GetSnapshot() : nullptr;
+    RefreshCrowdTransform(Ground.Get());
+
+    FRandomStream RNG(HashCombine(GetTypeHash(Seed), GetTypeHash(First)));
+
+    // Spawn on the grid, like StepAgents keeps them
+    float MinX = -FLT_MAX, MaxX = FLT_MAX, MinY = -FLT_MAX, MaxY = FLT_MAX;
+    if (Ground.IsValid() && Ground->IsValid())
+    {
+        MaxX = Ground->NumQuadsX * Ground->GridSpacing * 0.5f;
+        MaxY = Ground->NumQuadsY * Ground->GridSpacing * 0.5f;
+        MinX = -MaxX;
+        MinY = -MaxY;
+    }
+
+    const int32 Total = First + Count;
+    for (TArray<float>* Field : { &PosX, &PosY, &PosZ, &VelX, &VelY, &AgentMaxSpeed, &Yaw })
+    {
+        Field->Reserve(Total);
+    }
+    GroundCell.Reserve(Total);
+
+    for (int32 i = 0; i < Count; ++i)
+    {
+        const FVector2f XY = PickXY(RNG);
+        PosX.Add(FMath::Clamp(XY.X, MinX, MaxX));
+        PosY.Add(FMath::Clamp(XY.Y, MinY, MaxY));
+        PosZ.Add(StartZ);
+        VelX.Add(0.f);
+        VelY.Add(0.f);
+        AgentMaxSpeed.Add(MaxSpeed * (1.f + RNG.FRandRange(-SpeedVariance, SpeedVariance)));
+        Yaw.Add(RNG.FRandRange(0.f, 360.f));
+        GroundCell.Add(FIntPoint(INDEX_NONE, INDEX_NONE)); // far from anything: first lookup floors
+    }
+
+    if (Ground.IsValid() && Ground->IsValid())
+    {
+        GroundVersion = Ground->Version;
+        ClampToGround(*Ground);
+    }
+
+    // Grow the instance buffer once; transforms are written by UpdateInstances
+    TArray<FTransform> NewInstances;
+    NewInstances.SetNum(Count);
+    Instances->AddInstances(NewInstances, /*bShouldReturnIndices=*/false, /*bWorldSpace=*/true);
+    UpdateInstances();
+
+    return First;
+}
+
+void AHordeCrowd::SetOcclusion(TSharedPtr<const FTerrainHorizonOcclusion, ESPMode::ThreadSafe> InOcclusion)
+{
+    Occlusion = MoveTemp(InOcclusion);
+}
+
+void AHordeCrowd::ClearAgents()
+{
+    for (TArray<float>* Field : { &PosX, &PosY, &PosZ, &VelX, &VelY, &AgentMaxSpeed, &Yaw })
+    {
+        Field->Reset();
+    }
+    GroundCell.Reset();
+    InstanceTransforms.Reset();
+    SpatialIndex.Reset();
+    Instances->ClearInstances();
+}
+
+FVector AHordeCrowd::GetAgentLocation(int32 Index) const
+{
+    if (!PosX.IsValidIndex(Index)) return FVector::ZeroVector;
+    return CrowdToWorld.TransformPosition(FVector(PosX[Index], PosY[Index], PosZ[Index]));
+}
+
+void AHordeCrowd::Tick(float DeltaSeconds)
+{
+    Super::Tick(DeltaSeconds);
+
+    if (PosX.Num() == 0) return;
+
+    // Hold one snapshot for the whole step; a rebuild mid-frame publishes the next one
+    const FTerrainSnapshotPtr Ground = Terrain ? Terrain->GetSnapshot() : nullptr;
+    const FTerrainSnapshot* GroundData = (Ground.IsValid() && Ground->IsValid()) ? Ground.Get() : nullptr;
+    RefreshCrowdTransform(GroundData);
+
+    StepAgents(GroundData, DeltaSeconds);
+    UpdateInstances();
+
+    IndexGround = GroundData ? Ground : nullptr;
+    RebuildSpatialIndex(GroundData);
+}
+
+void AHordeCrowd::RebuildSpatialIndex(const FTerrainSnapshot* Ground)
+{
+    if (!bBuildSpatialIndex)
+    {
+        SpatialIndex.Reset();
+        return;
+    }
+
+    FVector2f Min, Max;
+    float CellSize;
+    if (Ground)
+    {
+        // Buckets on the terrain grid
+        Max = FVector2f(Ground->NumQuadsX * Ground->GridSpacing * 0.5f, Ground->NumQuadsY * Ground->GridSpacing * 0.5f);
+        Min = -Max;
+        CellSize = FMath::Max(IndexCellQuads, 1) * Ground->GridSpacing;
+    }
+    else
+    {
+        Min = FVector2f(FLT_MAX, FLT_MAX);
+        Max = FVector2f(-FLT_MAX, -FLT_MAX);
+        for (int32 i = 0; i < PosX.Num(); ++i)
+        {
+            Min = FVector2f(FMath::Min(Min.X, PosX[i]), FMath::Min(Min.Y, PosY[i]));
+            Max = FVector2f(FMath::Max(Max.X, PosX[i]), FMath::Max(Max.Y, PosY[i]));
+        }
+        CellSize = FMath::Max(IndexCellQuads, 1) * 100.f;
+    }
+
+    SpatialIndex.Build(PosX, PosY, PosZ, Min, Max, CellSize);
+}
+
+int32 AHordeCrowd::FindTargets(FVector WorldEye, float Radius, int32 MaxTargets, bool bRequireLineOfSight, TArray<int32>& OutAgents) const
+{
+    FHordeTargetQuery Query;
+    Query.Origin = CrowdToWorld.InverseTransformPosition(WorldEye);
+    Query.Radius = Radius;
+    Query.MaxResults = FMath::Max(MaxTargets, 0);
+    Query.bRequireLineOfSight = bRequireLineOfSight;
+    Query.TargetHeight = TargetHeight;
+
+    SpatialIndex.RunQuery(Query, IndexGround.Get(), OutAgents);
+    return OutAgents.Num();
+}
+
+void AHordeCrowd::FindTargetsBatch(TArrayView<const FHordeTargetQuery> WorldQueries, FHordeQueryResults& Out) const
+{
+    TArray<FHordeTargetQuery> LocalQueries(WorldQueries.GetData(), WorldQueries.Num());
+    for (FHordeTargetQuery& Query : LocalQueries)
+    {
+        Query.Origin = CrowdToWorld.InverseTransformPosition(Query.Origin);
+    }
+
+    SpatialIndex.RunQueryBatch(LocalQueries, IndexGround.Get(), Out);
+}
+
+void AHordeCrowd::StepAgents(const FTerrainSnapshot* Ground, float DeltaSeconds)
+{
+    const int32 Num = PosX.Num();
+    const FVector GoalLocal = CrowdToWorld.InverseTransformPosition(Goal);
+    const float GX = (float)GoalLocal.X;
+    const float GY = (float)GoalLocal.Y;
+    const float MaxDV = MaxAcceleration * DeltaSeconds;
+    const float InvArrive = 1.f / FMath::Max(ArriveRadius, 1.f);
+
+    // Keep agents on the grid
+    float MinX = -FLT_MAX, MaxX = FLT_MAX, MinY = -FLT_MAX, MaxY = FLT_MAX;
+    if (Ground)
+    {
+        MaxX = Ground->NumQuadsX * Ground->GridSpacing * 0.5f;
+        MaxY = Ground->NumQuadsY * Ground->GridSpacing * 0.5f;
+        MinX = -MaxX;
+        MinY = -MaxY;
+    }
+
+    const int32 Batch = FMath::Max(BatchSize, 16);
+    const int32 NumBatches = FMath::DivideAndRoundUp(Num, Batch);
+
+    ParallelFor(NumBatches, [&](int32 BatchIndex)
+    {
+        const int32 Begin = BatchIndex * Batch;
+        const int32 End = FMath::Min(Begin + Batch, Num);
+        for (int32 i = Begin; i < End; ++i)
+        {
+            // Seek the goal, easing off inside ArriveRadius
+            const float DX = GX - PosX[i];
+            const float DY = GY - PosY[i];
+            const float Dist = FMath::Sqrt(DX * DX + DY * DY);
+            const float Speed = AgentMaxSpeed[i] * FMath::Min(Dist * InvArrive, 1.f);
+            const float Scale = Dist > KINDA_SMALL_NUMBER ? Speed / Dist : 0.f;
+
+            float SX = DX * Scale - VelX[i];
+            float SY = DY * Scale - VelY[i];
+            const float Steer = FMath::Sqrt(SX * SX + SY * SY);
+            if (Steer > MaxDV)
+            {
+                SX *= MaxDV / Steer;
+                SY *= MaxDV / Steer;
+            }
+            VelX[i] += SX;
+            VelY[i] += SY;
+
+            PosX[i] = FMath::Clamp(PosX[i] + VelX[i] * DeltaSeconds, MinX, MaxX);
+            PosY[i] = FMath::Clamp(PosY[i] + VelY[i] * DeltaSeconds, MinY, MaxY);
+
+            if (VelX[i] * VelX[i] + VelY[i] * VelY[i] > 1.f)
+            {
+                Yaw[i] = FMath::RadiansToDegrees(FMath::Atan2(VelY[i], VelX[i]));
+            }
+        }
+    });
+
+    if (Ground)
+    {
+        ClampToGround(*Ground);
+    }
+}
+
+void AHordeCrowd::ClampToGround(const FTerrainSnapshot& Ground)
+{
+    // Cells from another snapshot may not even be on this grid
+    if (Ground.Version != GroundVersion)
+    {
+        GroundVersion = Ground.Version;
+        for (FIntPoint& Cell : GroundCell) Cell = FIntPoint(INDEX_NONE, INDEX_NONE);
+    }
+
+    const int32 Num = PosX.Num();
+    const int32 VertsX = Ground.NumQuadsX + 1;
+    const float InvSpacing = 1.f / Ground.GridSpacing;
+    const float OffsetU = Ground.NumQuadsX * 0.5f;
+    const float OffsetV = Ground.NumQuadsY * 0.5f;
+    const float* H = Ground.Heights.GetData();
+
+    const int32 Batch = FMath::Max(BatchSize, 16);
+    ParallelFor(FMath::DivideAndRoundUp(Num, Batch), [&](int32 BatchIndex)
+    {
+        const int32 Begin = BatchIndex * Batch;
+        const int32 End = FMath::Min(Begin + Batch, Num);
+        for (int32 i = Begin; i < End; ++i)
+        {
+            const float U = PosX[i] * InvSpacing + OffsetU;
+            const float V = PosY[i] * InvSpacing + OffsetV;
+
+            FIntPoint& Cell = GroundCell[i];
+            Cell.X = WalkCell(Cell.X, U, Ground.NumQuadsX - 1);
+            Cell.Y = WalkCell(Cell.Y, V, Ground.NumQuadsY - 1);
+
+            const float tx = FMath::Clamp(U - (float)Cell.X, 0.f, 1.f);
+            const float ty = FMath::Clamp(V - (float)Cell.Y, 0.f, 1.f);
+            const float* Row0 = H + Cell.Y * VertsX + Cell.X;
+            const float* Row1 = Row0 + VertsX;
+            PosZ[i] = FMath::Lerp(FMath::Lerp(Row0[0], Row0[1], tx), FMath::Lerp(Row1[0], Row1[1], tx), ty) + GroundOffset;
+        }
+    });
+}
+
+void AHordeCrowd::UpdateInstances()
+{
+    const int32 Num = PosX.Num();
+    if (Num == 0 || Instances->GetInstanceCount() != Num) return;
+
+    InstanceTransforms.SetNumUninitialized(Num, EAllowShrinking::No);
+
+    const FTerrainHorizonOcclusion* Hider = (Occlusion.IsValid() && Occlusion->IsValid()) ? Occlusion.Get() : nullptr;
+    NumOccludedAgents = 0;
+
+    const int32 Batch = FMath::Max(BatchSize, 16);
+    ParallelFor(FMath::DivideAndRoundUp(Num, Batch), [&](int32 BatchIndex)
+    {
+        const int32 Begin = BatchIndex * Batch;
+        const int32 End = FMath::Min(Begin + Batch, Num);
+        int32 Occluded = 0;
+        for (int32 i = Begin; i < End; ++i)
+        {
+            FTransform Local(FRotator(0.f, Yaw[i], 0.f), FVector(PosX[i], PosY[i], PosZ[i]));
+
+            // Zero scale keeps the instance slot (and agent index) but draws nothing
+            if (Hider && Hider->IsPointOccluded(PosX[i], PosY[i], PosZ[i] + OcclusionHeight))
+            {
+                Local.SetScale3D(FVector::ZeroVector);
+                ++Occluded;
+            }
+            InstanceTransforms[i] = Local * CrowdToWorld;
+        }
+        if (Occluded > 0)
+        {
+            FPlatformAtomics::InterlockedAdd(&NumOccludedAgents, Occluded);
+        }
+    });
+
+    Instances->BatchUpdateInstancesTransforms(0, InstanceTransforms, /*bWorldSpace=*/true,
+        /*bMarkRenderStateDirty=*/true, /*bTeleport=*/false);
+}
@@ -0,0 +1,219 @@
+#include "HordeSpatialIndex.h"
+#include "TerrainSnapshot.h"
+#include "Async/ParallelFor.h"
+
+namespace
+{
+    constexpr int32 BuildBatchSize = 1024;
+}
+
+void FHordeSpatialIndex::Reset()
+{
+    CellsX = CellsY = 0;
+    CellStart.Reset();
+    SortedAgent.Reset();
+    SortedX.Reset();
+    SortedY.Reset();
+    SortedZ.Reset();
+}
+
+void FHordeSpatialIndex::Build(const TArray<float>& X, const TArray<float>& Y, const TArray<float>& Z,
+    const FVector2f& Min, const FVector2f& Max, float InCellSize)
+{
+    const int32 NumAgents = X.Num();
+    check(Y.Num() == NumAgents && Z.Num() == NumAgents);
+
+    CellSize = FMath::Max(InCellSize, 1.f);
+    InvCellSize = 1.f / CellSize;
+    Origin = Min;
+    CellsX = FMath::Max(FMath::CeilToInt((Max.X - Min.X) * InvCellSize), 1);
+    CellsY = FMath::Max(FMath::CeilToInt((Max.Y - Min.Y) * InvCellSize), 1);
+    const int32 NumCells = CellsX * CellsY;
+
+    CellStart.SetNumZeroed(NumCells + 1, EAllowShrinking::No);
+    AgentCell.SetNumUninitialized(NumAgents, EAllowShrinking::No);
+    SortedAgent.SetNumUninitialized(NumAgents, EAllowShrinking::No);
+    SortedX.SetNumUninitialized(NumAgents, EAllowShrinking::No);
+    SortedY.SetNumUninitialized(NumAgents, EAllowShrinking::No);
+    SortedZ.SetNumUninitialized(NumAgents, EAllowShrinking::No);
+
+    const int32 NumBatches = FMath::DivideAndRoundUp(NumAgents, BuildBatchSize);
+
+    // 1) Bucket per agent + histogram (shifted by one so the prefix sum is exclusive)
+    ParallelFor(NumBatches, [&](int32 Batch)
+    {
+        const int32 End = FMath::Min((Batch + 1) * BuildBatchSize, NumAgents);
+        for (int32 i = Batch * BuildBatchSize; i < End; ++i)
+        {
+            const int32 Cell = CellCoordY(Y[i]) * CellsX + CellCoordX(X[i]);
+            AgentCell[i] = Cell;
+            FPlatformAtomics::InterlockedIncrement(&CellStart[Cell + 1]);
+        }
+    });
+
+    // 2) Prefix sum -> bucket starts
+    for (int32 c = 0; c < NumCells; ++c)
+    {
+        CellStart[c + 1] += CellStart[c];
+    }
+    CellCursor.SetNumUninitialized(NumCells, EAllowShrinking::No);
+    FMemory::Memcpy(CellCursor.GetData(), CellStart.GetData(), NumCells * sizeof(int32));
+
+    // 3) Scatter into the buckets (order inside a bucket is arbitrary)
+    ParallelFor(NumBatches, [&](int32 Batch)
+    {
+        const int32 End = FMath::Min((Batch + 1) * BuildBatchSize, NumAgents);
+        for (int32 i = Batch * BuildBatchSize; i < End; ++i)
+        {
+            const int32 Slot = FPlatformAtomics::InterlockedIncrement(&CellCursor[AgentCell[i]]) - 1;
+            SortedAgent[Slot] = i;
+            SortedX[Slot] = X[i];
+            SortedY[Slot] = Y[i];
+            SortedZ[Slot] = Z[i];
+        }
+    });
+}
+
+bool FHordeSpatialIndex::PassesLineOfSight(const FHordeTargetQuery& Query, const FTerrainSnapshot* Ground, int32 Slot) const
+{
+    if (!Query.bRequireLineOfSight || !Ground) return true;
+    return Ground->HasLineOfSightLocal(Query.Origin, FVector(SortedX[Slot], SortedY[Slot], SortedZ[Slot] + Query.TargetHeight));
+}
+
+void FHordeSpatialIndex::RunQuery(const FHordeTargetQuery& Query, const FTerrainSnapshot* Ground, TArray<int32>& OutAgents) const
+{
+    OutAgents.Reset();
+    if (!IsValid() || Num() == 0 || Query.Radius <= 0.f) return;
+
+    if (Query.MaxResults > 0)
+    {
+        QueryNearest(Query, Ground, OutAgents);
+    }
+    else
+    {
+        QueryAllInRange(Query, Ground, OutAgents);
+    }
+}
+
+void FHordeSpatialIndex::QueryAllInRange(const FHordeTargetQuery& Query, const FTerrainSnapshot* Ground, TArray<int32>& OutAgents) const
+{
+    const float QX = (float)Query.Origin.X;
+    const float QY = (float)Query.Origin.Y;
+    const float R2 = Query.Radius * Query.Radius;
+
+    const int32 X0 = CellCoordX(QX - Query.Radius), X1 = CellCoordX(QX + Query.Radius);
+    const int32 Y0 = CellCoordY(QY - Query.Radius), Y1 = CellCoordY(QY + Query.Radius);
+
+    for (int32 cy = Y0; cy <= Y1; ++cy)
+    {
+        for (int32 cx = X0; cx <= X1; ++cx)
+        {
+            const int32 Cell = cy * CellsX + cx;
+            for (int32 s = CellStart[Cell]; s < CellStart[Cell + 1]; ++s)
+            {
+                const float DX = SortedX[s] - QX;
+                const float DY = SortedY[s] - QY;
+                if (DX * DX + DY * DY <= R2 && PassesLineOfSight(Query, Ground, s))
+                {
+                    OutAgents.Add(SortedAgent[s]);
+                }
+            }
+        }
+    }
+}
+
+void FHordeSpatialIndex::QueryNearest(const FHordeTargetQuery& Query, const FTerrainSnapshot* Ground, TArray<int32>& OutAgents) const
+{
+    const float QX = (float)Query.Origin.X;
+    const float QY = (float)Query.Origin.Y;
+    const float R2 = Query.Radius * Query.Radius;
+    const int32 K = Query.MaxResults;
+
+    const int32 CX = CellCoordX(QX);
+    const int32 CY = CellCoordY(QY);
+    const int32 MaxRing = FMath::CeilToInt(Query.Radius * InvCellSize) + 1;
+
+    // Max-heap on distance: the worst of the current K is on top
+    using FCandidate = TPair<float, int32>;
+    auto Farther = [](const FCandidate& A, const FCandidate& B) { return A.Key > B.Key; };
+    TArray<FCandidate, TInlineAllocator<32>> Best;
+
+    auto VisitCell = [&](int32 cx, int32 cy)
+    {
+        if (cx < 0 || cy < 0 || cx >= CellsX || cy >= CellsY) return;
+
+        const int32 Cell = cy * CellsX + cx;
+        for (int32 s = CellStart[Cell]; s < CellStart[Cell + 1]; ++s)
+        {
+            const float DX = SortedX[s] - QX;
+            const float DY = SortedY[s] - QY;
+            const float D2 = DX * DX + DY * DY;
+            if (D2 > R2) continue;
+            if (Best.Num() == K && D2 >= Best.HeapTop().Key) continue;
+
+            // Line of sight only for agents that would make the cut
+            if (!PassesLineOfSight(Query, Ground, s)) continue;
+
+            if (Best.Num() == K)
+            {
+                Best.HeapPopDiscard(Farther, EAllowShrinking::No);
+            }
+            Best.HeapPush(FCandidate(D2, SortedAgent[s]), Farther);
+        }
+    };
+
+    // Rings of cells outward; everything in ring r is at least (r - 1) cells away
+    for (int32 r = 0; r <= MaxRing; ++r)
+    {
+        if (Best.Num() == K)
+        {
+            const float RingMin = FMath::Max(r - 1, 0) * CellSize;
+            if (RingMin * RingMin > Best.HeapTop().Key) break;
+        }
+
+        if (r == 0)
+        {
+            VisitCell(CX, CY);
+            continue;
+        }
+        for (int32 dx = -r; dx <= r; ++dx)
+        {
+            VisitCell(CX + dx, CY - r);
+            VisitCell(CX + dx, CY + r);
+        }
+        for (int32 dy = -r + 1; dy <= r - 1; ++dy)
+        {
+            VisitCell(CX - r, CY + dy);
+            VisitCell(CX + r, CY + dy);
+        }
+    }
+
+    Best.Sort([](const FCandidate& A, const FCandidate& B) { return A.Key < B.Key; });
+    OutAgents.Reserve(Best.Num());
+    for (const FCandidate& C : Best)
+    {
+        OutAgents.Add(C.Value);
+    }
+}
+
+void FHordeSpatialIndex::RunQueryBatch(TArrayView<const FHordeTargetQuery> Queries, const FTerrainSnapshot* Ground, FHordeQueryResults& Out) const
+{
+    const int32 NumQueries = Queries.Num();
+
+    TArray<TArray<int32>> PerQuery;
+    PerQuery.SetNum(NumQueries);
+    ParallelFor(NumQueries, [&](int32 q)
+    {
+        RunQuery(Queries[q], Ground, PerQuery[q]);
+    });
+
+    Out.Agents.Reset();
+    Out.Start.SetNumUninitialized(NumQueries);
+    Out.Count.SetNumUninitialized(NumQueries);
+    for (int32 q = 0; q < NumQueries; ++q)
+    {
+        Out.Start[q] = Out.Agents.Num();
+        Out.Count[q] = PerQuery[q].Num();
+        Out.Agents.Append(PerQuery[q]);
+    }
+}
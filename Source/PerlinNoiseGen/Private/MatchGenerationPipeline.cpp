@@ -0,0 +1,169 @@
+#include "MatchGenerationPipeline.h"
+#include "NoiseTerrainActor.h"
+#include "ScatterSpawner.h"
+
+AMatchGenerationPipeline::AMatchGenerationPipeline()
+{
+    PrimaryActorTick.bCanEverTick = true;
+    PrimaryActorTick.bStartWithTickEnabled = false;
+}
+
+void AMatchGenerationPipeline::BeginPlay()
+{
+    Super::BeginPlay();
+
+    if (bStartOnBeginPlay)
+    {
+        StartGeneration();
+    }
+}
+
+void AMatchGenerationPipeline::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+    // Workers write into the terrain and spawners; don't let them outlive the level
+    WaitForWorkers();
+    Stages.Reset();
+    CurrentStage = INDEX_NONE;
+
+    Super::EndPlay(EndPlayReason);
+}
+
+void AMatchGenerationPipeline::WaitForWorkers()
+{
+    UE::Tasks::Wait(WorkerTasks);
+    WorkerTasks.Reset();
+}
+
+void AMatchGenerationPipeline::StartGeneration()
+{
+    if (!Terrain)
+    {
+        UE_LOG(LogTemp, Warning, TEXT("MatchGenerationPipeline: Terrain not set."));
+        return;
+    }
+
+    WaitForWorkers();
+    Stages.Reset();
+    StartSeconds = FPlatformTime::Seconds();
+
+    ANoiseTerrainActor* Ground = Terrain;
+
+    // Heights, erosion, water map, normals: everything the rest of the graph reads
+    Ground->BeginStagedBuild();
+    const UE::Tasks::FTask HeightsTask = UE::Tasks::Launch(UE_SOURCE_LOCATION, [Ground]()
+    {
+        Ground->ComputeStagedBuild();
+    });
+    WorkerTasks.Add(HeightsTask);
+
+    {
+        FStage& Stage = Stages.AddDefaulted_GetRef();
+        Stage.Name = TEXT("Terrain");
+        Stage.Weight = 3.f;
+        Stage.Prerequisite = HeightsTask;
+        Stage.Commit = [Ground](double Deadline) { return Ground->CommitStagedBuild(Deadline); };
+    }
+
+    // Placement only reads the terrain's staged snapshot, so every spawner computes in parallel once
+    // heights exist, while the live terrain keeps serving queries from the previous build
+    const FTerrainSnapshotPtr StagedGround = Ground->GetStagedSnapshot();
+    for (AScatterSpawner* Spawner : Scatterers)
+    {
+        if (!Spawner) continue;
+        if (Spawner->Terrain != Ground)
+        {
+            UE_LOG(LogTemp, Warning, TEXT("MatchGenerationPipeline: %s scatters on another terrain; skipped."),
+                *Spawner->GetName());
+            continue;
+        }
+        if (!Spawner->BeginStagedGenerate()) continue;
+
+        const UE::Tasks::FTask PlaceTask = UE::Tasks::Launch(UE_SOURCE_LOCATION, [Spawner, StagedGround]()
+        {
+            Spawner->ComputeStagedGenerate(StagedGround);
+        }, UE::Tasks::Prerequisites(HeightsTask));
+        WorkerTasks.Add(PlaceTask);
+
+        FStage& Stage = Stages.AddDefaulted_GetRef();
+        Stage.Name = TEXT("Scatter");
+        Stage.Weight = 2.f;
+        Stage.Prerequisite = PlaceTask;
+        Stage.Commit = [Spawner](double Deadline) { return Spawner->CommitStagedGenerate(Deadline); };
+        Stage.Progress = [Spawner]() { return Spawner->GetStagedProgress(); };
+    }
+
+    if (bWaitForCollision)
+    {
+        FStage& Stage = Stages.AddDefaulted_GetRef();
+        Stage.Name = TEXT("Collision");
+        Stage.Commit = [Ground](double /*Deadline*/)
+        {
+            return !Ground->bCreateCollision
+                || Ground->CollisionMode == ETerrainCollisionMode::None
+                || Ground->GetCollisionReadyFraction() >= 1.f;
+        };
+        Stage.Progress = [Ground]() { return Ground->GetCollisionReadyFraction(); };
+    }
+
+    CurrentStage = 0;
+    SetActorTickEnabled(true);
+}
+
+float AMatchGenerationPipeline::GetProgress() const
+{
+    if (Stages.Num() == 0) return 0.f;
+
+    float Total = 0.f;
+    float Done = 0.f;
+    for (int32 i = 0; i < Stages.Num(); ++i)
+    {
+        const FStage& Stage = Stages[i];
+        Total += Stage.Weight;
+
+        if (i < CurrentStage)
+        {
+            Done += Stage.Weight;
+        }
+        else if (i == CurrentStage && Stage.Progress && Stage.Prerequisite.IsCompleted())
+        {
+            Done += Stage.Weight * FMath::Clamp(Stage.Progress(), 0.f, 1.f);
+        }
+    }
+    return Total > 0.f ? Done / Total : 1.f;
+}
+
+void AMatchGenerationPipeline::Tick(float DeltaSeconds)
+{
+    Super::Tick(DeltaSeconds);
+
+    if (!IsGenerating())
+    {
+        SetActorTickEnabled(false);
+        return;
+    }
+
+    const double Deadline = FPlatformTime::Seconds() + FrameBudgetMs * 0.001;
+
+    // Stages commit strictly in order; a stage whose worker isn't done yet blocks the ones behind it
+    while (IsGenerating() && FPlatformTime::Seconds() < Deadline)
+    {
+        FStage& Stage = Stages[CurrentStage];
+        if (Stage.Prerequisite.IsValid() && !Stage.Prerequisite.IsCompleted()) break;
+
+        if (!Stage.Commit(Deadline)) break;
+        ++CurrentStage;
+    }
+
+    const FName StageName = IsGenerating() ? Stages[CurrentStage].Name : FName(TEXT("Done"));
+    OnProgress.Broadcast(GetProgress(), StageName);
+
+    if (!IsGenerating())
+    {
+        UE_LOG(LogTemp, Log, TEXT("MatchGenerationPipeline: generated in %.1f ms"),
+            (FPlatformTime::Seconds() - StartSeconds) * 1000.0);
+
+        WorkerTasks.Reset();
+        SetActorTickEnabled(false);
+        OnComplete.Broadcast();
+    }
+}
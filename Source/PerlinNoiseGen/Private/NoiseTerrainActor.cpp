@@ -1,235 +1,1807 @@
 #include "NoiseTerrainActor.h"
 #include "ProceduralMeshComponent.h"
+#include "TerrainMeshComponent.h"
 #include "PerlinNoise.h"   
-#include "DrawDebugHelpers.h"
+#include "Engine/Engine.h"
+#include "Materials/Material.h"
+#include "GameFramework/PlayerController.h"
+#include "GameFramework/Pawn.h"
+#include "PhysicsEngine/BodySetup.h"
+#include "Async/ParallelFor.h"
+#include "Hash/CityHash.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Misc/ScopeRWLock.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+namespace
+{
+    // On-disk height cache header; bump the version whenever the height pipeline changes
+    constexpr uint32 HeightCacheMagic = 0x31435448; // "HTC1"
+    constexpr int32 HeightCacheVersion = 1;
+
+    // Deformation follow-ups that don't split into tiles (SATs, ProcMesh section, snapshot) wait this long after the last edit
+    constexpr double DeformSettleSeconds = 0.25;
+
+    const FIntRect EmptyDirtyRect(0, 0, -1, -1);
+}
+
+ANoiseTerrainActor::ANoiseTerrainActor()
+{
+    // Ticks only while collision tiles are cooking, deformation is catching up or a preview is refining
+    PrimaryActorTick.bCanEverTick = true;
+    PrimaryActorTick.bStartWithTickEnabled = false;
+
+    ProcMesh = CreateDefaultSubobject<UProceduralMeshComponent>(TEXT("ProceduralMesh"));
+    ProcMesh->bUseAsyncCooking = true;
+    SetRootComponent(ProcMesh);
+
+    TerrainMesh = CreateDefaultSubobject<UTerrainMeshComponent>(TEXT("TerrainMesh"));
+    TerrainMesh->SetupAttachment(ProcMesh);
+
+    DebugOverlayMesh = CreateDefaultSubobject<UTerrainMeshComponent>(TEXT("DebugOverlayMesh"));
+    DebugOverlayMesh->SetupAttachment(ProcMesh);
+    DebugOverlayMesh->SetCastShadow(false);
+    DebugOverlayMesh->SetVisibility(false);
+
+    // Allocate the noise generator
+    ResetNoise();
+}
+
+void ANoiseTerrainActor::OnConstruction(const FTransform& Transform)
+{
+    if (ShouldPreviewProgressively())
+    {
+        BeginProgressivePreview();
+        return;
+    }
+    BuildMesh();
+}
+
+void ANoiseTerrainActor::Regenerate()
+{
+    BuildMesh();
+}
+
+void ANoiseTerrainActor::ResetNoise()
+{
+    // Reseeding refills the permutation table in place, so builds after the first don't allocate
+    if (NoisePtr.IsValid() && NoisePtr.IsUnique())
+    {
+        NoisePtr->reseed(Seed);
+    }
+    else
+    {
+        NoisePtr = MakeShared<FPerlinNoise, ESPMode::ThreadSafe>(Seed);
+    }
+}
+
+void ANoiseTerrainActor::PublishSnapshot()
+{
+    const TSharedPtr<FTerrainSnapshot, ESPMode::ThreadSafe> New = AllocSnapshot();
+    FillSnapshot(*New, HeightCache, WaterMap);
+    SwapInSnapshot(New);
+}
+
+void ANoiseTerrainActor::PublishDeformedSnapshot()
+{
+    bDeformSnapshotDirty = false;
+    PublishSnapshot();
+
+    if (DebugOverlay != ETerrainDebugOverlay::None)
+    {
+        RefreshDebugOverlay();
+    }
+}
+
+TSharedPtr<FTerrainSnapshot, ESPMode::ThreadSafe> ANoiseTerrainActor::AllocSnapshot()
+{
+    // Refill the snapshot retired last time if no reader still holds it, so its arrays keep their capacity
+    TSharedPtr<FTerrainSnapshot, ESPMode::ThreadSafe> New;
+    if (SpareSnapshot.IsValid() && SpareSnapshot.IsUnique())
+    {
+        New = MoveTemp(SpareSnapshot);
+    }
+    else
+    {
+        New = MakeShared<FTerrainSnapshot, ESPMode::ThreadSafe>();
+    }
+    SpareSnapshot.Reset();
+    return New;
+}
+
+void ANoiseTerrainActor::FillSnapshot(FTerrainSnapshot& Out, const TArray<float>& Heights, const FTerrainWaterMap& Water)
+{
+    Out.NumQuadsX = NumQuadsX;
+    Out.NumQuadsY = NumQuadsY;
+    Out.GridSpacing = GridSpacing;
+    Out.ActorTransform = GetActorTransform();
+    Out.Heights.SetNumUninitialized(Heights.Num(), EAllowShrinking::No);
+    FMemory::Memcpy(Out.Heights.GetData(), Heights.GetData(), Heights.Num() * sizeof(float));
+
+    const TArray<float>& Shore = Water.GetShoreDistances();
+    Out.ShoreDistance.SetNumUninitialized(Water.IsValid() ? Shore.Num() : 0, EAllowShrinking::No);
+    FMemory::Memcpy(Out.ShoreDistance.GetData(), Shore.GetData(), Out.ShoreDistance.Num() * sizeof(float));
+
+    Out.WaterZ = WaterZ;
+    Out.bEnableFlatten = bEnableFlatten;
+    Out.FlattenCenter = FlattenCenter;
+    Out.FlattenSize = FlattenSize;
+    Out.FlattenHeight = FlattenHeight;
+    Out.FlattenFalloff = FlattenFalloff;
+
+    // Nothing else publishes while a staged build fills its snapshot, so versions still rise in publish order
+    FWriteScopeLock Lock(SnapshotLock);
+    Out.Version = ++SnapshotVersion;
+}
+
+void ANoiseTerrainActor::SwapInSnapshot(const TSharedPtr<FTerrainSnapshot, ESPMode::ThreadSafe>& New)
+{
+    FTerrainSnapshotPtr Retired;
+    {
+        FWriteScopeLock Lock(SnapshotLock);
+        Retired = MoveTemp(Snapshot);
+        Snapshot = New;
+    }
+
+    // Only written here, before publish; readers that still hold it keep it alive and block reuse
+    if (bRetainGenerationBuffers)
+    {
+        SpareSnapshot = ConstCastSharedPtr<FTerrainSnapshot>(Retired);
+    }
+}
+
+FTerrainSnapshotPtr ANoiseTerrainActor::GetSnapshot() const
+{
+    FReadScopeLock Lock(SnapshotLock);
+    return Snapshot;
+}
+
+FTerrainSnapshotPtr ANoiseTerrainActor::GetUpToDateSnapshot()
+{
+    // Edits publish once they settle; callers about to place things on the surface can't wait for that
+    if (bDeformSnapshotDirty)
+    {
+        PublishDeformedSnapshot();
+    }
+    return GetSnapshot();
+}
+
+uint64 ANoiseTerrainActor::GetSnapshotVersion() const
+{
+    FReadScopeLock Lock(SnapshotLock);
+    return Snapshot.IsValid() ? Snapshot->Version : 0;
+}
+
+void ANoiseTerrainActor::Tick(float DeltaSeconds)
+{
+    Super::Tick(DeltaSeconds);
+
+    if (HasPendingDeformation())
+    {
+        ProcessDeformation();
+    }
+    if (HasPendingCollisionCooks())
+    {
+        PumpCollisionCooking();
+    }
+    if (PreviewPassStride > 0)
+    {
+        AdvanceProgressivePreview();
+    }
+
+    if (PreviewPassStride == 0 && !HasPendingDeformation() && !HasPendingCollisionCooks())
+    {
+        SetActorTickEnabled(false);
+    }
+}
+
+void ANoiseTerrainActor::BuildMesh()
+{
+    BeginStagedBuild();
+    ComputeStagedBuild();
+    CommitStagedBuild(DBL_MAX);
+}
+
+bool ANoiseTerrainActor::ShouldPreviewProgressively() const
+{
+#if WITH_EDITOR
+    // Game worlds (PIE included) always get the full build at once
+    const UWorld* World = GetWorld();
+    return bProgressivePreview && World && !World->IsGameWorld() && !IsRunningCommandlet()
+        && FMath::Min(NumQuadsX, NumQuadsY) > PreviewStride;
+#else
+    return false;
+#endif
+}
+
+void ANoiseTerrainActor::BeginProgressivePreview()
+{
+    // Same reset as a full build; height queries sample the noise until it lands
+    ResetNoise();
+    ResetDeformation();
+    UpdateNoiseGridOrigin();
+    bCacheValid = false;
+
+    // Collision, slab and water no longer match; the full pass recreates them
+    if (ProcMesh)
+    {
+        ProcMesh->ClearAllMeshSections();
+    }
+    if (DebugOverlayMesh)
+    {
+        DebugOverlayMesh->SetVisibility(false);
+    }
+
+    // Every edit restarts from the coarsest pass, which cancels any refinement in progress
+    PreviewEditTime = FPlatformTime::Seconds();
+    BuildPreviewPass(FMath::Max(PreviewStride, 2));
+    SetActorTickEnabled(true);
+}
+
+void ANoiseTerrainActor::AdvanceProgressivePreview()
+{
+    if (FPlatformTime::Seconds() - PreviewEditTime < PreviewRefineDelay) return;
+
+    // One pass per tick, so the editor stays responsive and a new edit can cut in between them
+    const int32 NextStride = PreviewPassStride / 2;
+    if (NextStride > 1)
+    {
+        BuildPreviewPass(NextStride);
+    }
+    else
+    {
+        BuildMesh();
+    }
+}
+
+void ANoiseTerrainActor::BuildPreviewPass(int32 Stride)
+{
+    const double StartSeconds = FPlatformTime::Seconds();
+
+    FTerrainMeshData& Data = PreviewMeshData;
+    Data.NumQuadsX = FMath::DivideAndRoundUp(NumQuadsX, Stride);
+    Data.NumQuadsY = FMath::DivideAndRoundUp(NumQuadsY, Stride);
+    Data.GridSpacing = GridSpacing * Stride;
+    Data.TileQuads = RenderTileQuads;
+
+    const int32 VertsX = Data.NumQuadsX + 1;
+    const int32 VertsY = Data.NumQuadsY + 1;
+    const float HalfW = NumQuadsX * GridSpacing * 0.5f;
+    const float HalfH = NumQuadsY * GridSpacing * 0.5f;
+
+    // Every Stride-th vertex of the full grid, from the same noise; the overhanging last row/column
+    // repeats our border
+    Data.Heights.SetNumUninitialized(VertsX * VertsY, EAllowShrinking::No);
+    ParallelFor(VertsY, [&](int32 y)
+    {
+        const int32 sy = FMath::Min(y * Stride, NumQuadsY);
+        for (int32 x = 0; x < VertsX; ++x)
+        {
+            const int32 sx = FMath::Min(x * Stride, NumQuadsX);
+            Data.Heights[y * VertsX + x] = SampleHeightAtIndex(sx, sy, sx * GridSpacing - HalfW, sy * GridSpacing - HalfH);
+        }
+    });
+
+    const FBlendWeightRamps Ramps = GetBlendWeightRamps();
+    Data.Normals.SetNumUninitialized(VertsX * VertsY, EAllowShrinking::No);
+    if (bBakeBlendWeights)
+    {
+        Data.Colors.SetNumUninitialized(VertsX * VertsY, EAllowShrinking::No);
+    }
+    else
+    {
+        Data.Colors.Reset();
+    }
+
+    ParallelFor(VertsY, [&](int32 y)
+    {
+        const int32 y0 = FMath::Max(y - 1, 0), y1 = FMath::Min(y + 1, VertsY - 1);
+        const float LocalY = FMath::Min(y * Stride, NumQuadsY) * GridSpacing - HalfH;
+        for (int32 x = 0; x < VertsX; ++x)
+        {
+            const int32 i = y * VertsX + x;
+
+            // Central differences on the preview grid (one-sided at the border)
+            const int32 x0 = FMath::Max(x - 1, 0), x1 = FMath::Min(x + 1, VertsX - 1);
+            const float DZDX = (Data.Heights[y * VertsX + x1] - Data.Heights[y * VertsX + x0]) / ((x1 - x0) * Data.GridSpacing);
+            const float DZDY = (Data.Heights[y1 * VertsX + x] - Data.Heights[y0 * VertsX + x]) / ((y1 - y0) * Data.GridSpacing);
+            const FVector3f N = FVector3f(-DZDX, -DZDY, 1.f).GetSafeNormal();
+            Data.Normals[i] = FPackedNormal(N);
+
+            // No water map before the full pass, so no shore weight yet
+            if (bBakeBlendWeights)
+            {
+                const float Pad = FlattenWeightAtLocalXY(FMath::Min(x * Stride, NumQuadsX) * GridSpacing - HalfW, LocalY);
+                Data.Colors[i] = BlendWeightsAt(Ramps, N.Z, Data.Heights[i], 0.f, Pad);
+            }
+        }
+    });
+    Data.RecomputeBounds();
+
+    // Centered on its own (possibly overhanging) extent, like the debug overlay; line it up with ours
+    TerrainMesh->SetRelativeLocation(FVector(
+        0.5f * (Data.NumQuadsX * Data.GridSpacing - NumQuadsX * GridSpacing),
+        0.5f * (Data.NumQuadsY * Data.GridSpacing - NumQuadsY * GridSpacing),
+        0.f));
+
+    const int32 PreviewQuadsX = Data.NumQuadsX;
+    const int32 PreviewQuadsY = Data.NumQuadsY;
+    CommitCompactMesh(Data);
+    PreviewPassStride = Stride;
+
+    UE_LOG(LogTemp, Verbose, TEXT("NoiseTerrain: preview stride %d (%dx%d) in %.1f ms"),
+        Stride, PreviewQuadsX, PreviewQuadsY, (FPlatformTime::Seconds() - StartSeconds) * 1000.0);
+}
+
+void ANoiseTerrainActor::BeginStagedBuild()
+{
+    // The edits' catch-up is superseded, and nothing cooks from the old heights any more; in-flight
+    // cooks land harmlessly and commit step 2 queues every tile again
+    ResetNoise();
+    ResetDeformation();
+    UpdateNoiseGridOrigin();
+
+    CollisionCookQueue.Reset();
+    CollisionCookCursor = 0;
+    CollisionCooking.Reset();
+    CollisionTileDirty.Init(false, CollisionTileDirty.Num());
+
+    // Queries keep reading the previous build until commit step 0 swaps the staged one in
+    Staged.CommitStep = 0;
+    Staged.Snapshot = AllocSnapshot();
+
+    // A full build supersedes any preview refinement still queued
+    PreviewPassStride = 0;
+
+    // Back to the configured collision mode; commit step 2 drops the deformation tiles
+    bDeformCollisionTiled = false;
+}
+
+void ANoiseTerrainActor::ComputeStagedBuild()
+{
+    // Only Staged is written here; the live grid and everything derived from it stay untouched
+    GenerateGrid(Staged);
+
+    if (bUseCompactTerrainMesh)
+    {
+        BuildCompactMeshData(Staged.Heights, Staged.Normals, Staged.Colors, Staged.MeshData);
+    }
+
+    FillSnapshot(*Staged.Snapshot, Staged.Heights, Staged.WaterMap);
+
+    UpdatePeakGenerationMemory();
+}
+
+bool ANoiseTerrainActor::CommitStagedBuild(double DeadlineSeconds)
+{
+    const bool bFullMeshCollision = bCreateCollision && CollisionMode == ETerrainCollisionMode::FullMesh;
+
+    // Each step is one engine call that can't be split further; the deadline is checked between them
+    while (Staged.CommitStep < FStagedTerrainBuild::NumCommitSteps)
+    {
+        switch (Staged.CommitStep++)
+        {
+        case 0:
+            // The new grid goes live for queries all at once; Staged keeps the old buffers for the next build
+            Swap(HeightCache, Staged.Heights);
+            Swap(WaterMap, Staged.WaterMap);
+            Swap(FootprintTables, Staged.FootprintTables);
+            Swap(SpawnZones, Staged.SpawnZones);
+            bCacheValid = true;
+
+            // Slab, water and section 0's collision are rebuilt below
+            ProcMesh->ClearAllMeshSections();
+
+            // Drop the offset a preview pass may have left
+            TerrainMesh->SetRelativeLocation(FVector::ZeroVector);
+
+            if (bUseCompactTerrainMesh)
+            {
+                CommitCompactMesh(Staged.MeshData);
+            }
+            else
+            {
+                TerrainMesh->ClearMeshData();
+
+                ProcMesh->CreateMeshSection(
+                    0,
+                    Staged.Vertices,
+                    Staged.Triangles,
+                    Staged.Normals,
+                    Staged.UVs,
+                    Staged.Colors,
+                    Staged.Tangents,
+                    bFullMeshCollision
+                );
+            }
+            break;
+
+        case 1:
+            // Section 0 only survives as the FullMesh collision source
+            if (bUseCompactTerrainMesh && bFullMeshCollision)
+            {
+                ProcMesh->CreateMeshSection_LinearColor(0, Staged.Vertices, Staged.Triangles, TArray<FVector>(), TArray<FVector2D>(),
+                    TArray<FLinearColor>(), TArray<FProcMeshTangent>(), /*bCreateCollision=*/true);
+                ProcMesh->SetMeshSectionVisible(0, false);
+            }
+            break;
+
+        case 2:
+            if (bCreateCollision && CollisionMode == ETerrainCollisionMode::CoarseTiles)
+            {
+                BuildCollisionTiles();
+            }
+            else
+            {
+                ClearCollisionTiles();
+            }
+
+            if (TerrainMaterial)
+            {
+                ProcMesh->SetMaterial(0, TerrainMaterial);
+            }
+
+            if (bShowSlab && bEnableFlatten)
+            {
+                BuildSlabSection(); // creates section 1, no collision
+            }
+
+            // Water last so it renders on top where visible
+            if (bShowWater)
+            {
+                BuildWaterSection(); // creates section 2, no collision
+            }
+            break;
+
+        case 3:
+            SwapInSnapshot(Staged.Snapshot);
+            Staged.Snapshot.Reset();
+
+            RefreshDebugOverlay();
+
+            // Nothing below outlives the build; retained, its capacity serves the next one
+            UpdatePeakGenerationMemory();
+            if (bRetainGenerationBuffers)
+            {
+                Staged.Vertices.Reset();
+                Staged.Triangles.Reset();
+                Staged.Normals.Reset();
+                Staged.UVs.Reset();
+                Staged.Tangents.Reset();
+                Staged.Colors.Reset();
+            }
+            else
+            {
+                Staged.Empty();
+                Scratch.Empty();
+                DebugOverlayData = FTerrainMeshData();
+                PreviewMeshData = FTerrainMeshData();
+            }
+
+            UE_LOG(LogTemp, Verbose, TEXT("NoiseTerrain: generation buffers %.2f MB (peak %.2f MB), process peak %.1f MB"),
+                GetGenerationMemoryBytes() / (1024.0 * 1024.0), PeakGenerationMemoryBytes / (1024.0 * 1024.0),
+                FPlatformMemory::GetStats().PeakUsedPhysical / (1024.0 * 1024.0));
+            break;
+        }
+
+        if (FPlatformTime::Seconds() >= DeadlineSeconds) break;
+    }
+
+    return Staged.CommitStep >= FStagedTerrainBuild::NumCommitSteps;
+}
+
+
+SIZE_T ANoiseTerrainActor::FStagedTerrainBuild::GetAllocatedSize() const
+{
+    return Heights.GetAllocatedSize() + WaterMap.GetAllocatedSize() + FootprintTables.GetAllocatedSize()
+        + SpawnZones.GetAllocatedSize()
+        + Vertices.GetAllocatedSize() + Triangles.GetAllocatedSize() + Normals.GetAllocatedSize()
+        + UVs.GetAllocatedSize() + Tangents.GetAllocatedSize() + Colors.GetAllocatedSize()
+        + MeshData.GetAllocatedSize();
+}
+
+void ANoiseTerrainActor::FStagedTerrainBuild::Empty()
+{
+    Heights.Empty();
+    WaterMap = FTerrainWaterMap();
+    FootprintTables = FTerrainFootprintTables();
+    SpawnZones = FTerrainSpawnZones();
+    Vertices.Empty();
+    Triangles.Empty();
+    Normals.Empty();
+    UVs.Empty();
+    Tangents.Empty();
+    Colors.Empty();
+    MeshData = FTerrainMeshData();
+}
+
+SIZE_T ANoiseTerrainActor::FBuildScratch::GetAllocatedSize() const
+{
+    return Vertices.GetAllocatedSize() + Indices.GetAllocatedSize() + Normals.GetAllocatedSize()
+        + UVs.GetAllocatedSize() + Tangents.GetAllocatedSize() + Colors.GetAllocatedSize()
+        + LinesX.GetAllocatedSize() + LinesY.GetAllocatedSize() + TileDist2.GetAllocatedSize()
+        + WetCells.GetAllocatedSize() + WaterRects.GetAllocatedSize() + OpenRects.GetAllocatedSize()
+        + NextOpenRects.GetAllocatedSize() + FileBytes.GetAllocatedSize() + Erosion.GetAllocatedSize()
+        + ApronHeights.GetAllocatedSize();
+}
+
+void ANoiseTerrainActor::FBuildScratch::Empty()
+{
+    *this = FBuildScratch();
+}
+
+void ANoiseTerrainActor::ReleaseGenerationBuffers()
+{
+    Staged.Empty();
+    Scratch.Empty();
+    SpareSnapshot.Reset();
+    DebugOverlayData = FTerrainMeshData();
+    PreviewMeshData = FTerrainMeshData();
+    PeakGenerationMemoryBytes = GetGenerationMemoryBytes();
+}
+
+int64 ANoiseTerrainActor::GetGenerationMemoryBytes() const
+{
+    SIZE_T Bytes = HeightCache.GetAllocatedSize()
+        + Staged.GetAllocatedSize()
+        + Scratch.GetAllocatedSize()
+        + WaterMap.GetAllocatedSize()
+        + FootprintTables.GetAllocatedSize()
+        + SpawnZones.GetAllocatedSize()
+        + DebugOverlayData.GetAllocatedSize()
+        + PreviewMeshData.GetAllocatedSize();
+    if (SpareSnapshot.IsValid())
+    {
+        Bytes += SpareSnapshot->Heights.GetAllocatedSize();
+    }
+    return (int64)Bytes;
+}
+
+void ANoiseTerrainActor::UpdatePeakGenerationMemory()
+{
+    PeakGenerationMemoryBytes = FMath::Max(PeakGenerationMemoryBytes, GetGenerationMemoryBytes());
+}
+
+void ANoiseTerrainActor::GenerateGrid(FStagedTerrainBuild& Out)
+{
+    check(NoisePtr);
+
+    TArray<float>& Heights = Out.Heights;
+    TArray<FVector>& OutVertices = Out.Vertices;
+    TArray<int32>& OutTriangles = Out.Triangles;
+    TArray<FVector>& OutNormals = Out.Normals;
+    TArray<FVector2D>& OutUVs = Out.UVs;
+    TArray<FProcMeshTangent>& OutTangents = Out.Tangents;
+    TArray<FColor>& OutColors = Out.Colors;
+
+    const int32 VertsX = NumQuadsX + 1;
+    const int32 VertsY = NumQuadsY + 1;
+    const int32 TotalVerts = VertsX * VertsY;
+
+    const float HalfW = NumQuadsX * GridSpacing * 0.5f;
+    const float HalfH = NumQuadsY * GridSpacing * 0.5f;
+
+    OutVertices.SetNumUninitialized(TotalVerts, EAllowShrinking::No);
+    OutUVs.SetNumUninitialized(TotalVerts, EAllowShrinking::No);
+
+    // --- Heights: noise + flatten, optionally eroded ---
+    BuildHeightCache(Heights, VertsX, VertsY);
+
+    // Lakes + shore distance (blend weights read it below)
+    Out.WaterMap.Build(Heights, VertsX, VertsY, GridSpacing, WaterZ);
+
+    int32 Index = 0;
+    for (int32 y = 0; y < VertsY; ++y)
+    {
+        for (int32 x = 0; x < VertsX; ++x, ++Index)
+        {
+            const float LocalX = x * GridSpacing - HalfW;  // centered
+            const float LocalY = y * GridSpacing - HalfH;
+
+            OutVertices[Index] = FVector(LocalX, LocalY, Heights[Index]);
+            OutUVs[Index] = FVector2D(
+                (float)x / (float)NumQuadsX,
+                (float)y / (float)NumQuadsY
+            );
+        }
+    }
+
+
+    // --- Optional softening pass (one-iteration Laplacian-like) ---
+    //if (bSmoothHeights)
+    //{
+    //    TArray<float> H; H.SetNumUninitialized(TotalVerts);
+    //    for (int32 i = 0; i < TotalVerts; ++i) H[i] = OutVertices[i].Z;
+
+    //    for (int32 y = 1; y < VertsY - 1; ++y)
+    //    {
+    //        for (int32 x = 1; x < VertsX - 1; ++x)
+    //        {
+    //            const int32 i = y * VertsX + x;
+    //            const int32 l = i - 1, r = i + 1, u = i - VertsX, d = i + VertsX;
+    //            OutVertices[i].Z = (H[i] + H[l] + H[r] + H[u] + H[d]) / 5.f;
+    //        }
+    //    }
+    //}
+
+    // --- Triangles (CCW, facing +Z) ---
+    OutTriangles.Reset();
+    OutTriangles.Reserve(NumQuadsX * NumQuadsY * 6);
+    auto V = [VertsX](int32 X, int32 Y) { return Y * VertsX + X; };
+
+    for (int32 y = 0; y < NumQuadsY; ++y)
+    {
+        for (int32 x = 0; x < NumQuadsX; ++x)
+        {
+            const int32 v00 = V(x, y);
+            const int32 v10 = V(x + 1, y);
+            const int32 v01 = V(x, y + 1);
+            const int32 v11 = V(x + 1, y + 1);
+
+            // Front faces up (+Z)
+            OutTriangles.Add(v00); OutTriangles.Add(v11); OutTriangles.Add(v10);
+            OutTriangles.Add(v00); OutTriangles.Add(v01); OutTriangles.Add(v11);
+        }
+    }
+
+    // --- Fast, smooth area-weighted normals ---
+    // Per vertex from the heights, so deformation can recompute any region identically
+    ComputeGridNormals(Heights, OutNormals);
+
+
+    // --- Footprint summed-area tables ---
+    if (bBuildFootprintTables)
+    {
+        Out.FootprintTables.Build(Heights, VertsX, VertsY, bFootprintSlopeTable ? &OutNormals : nullptr);
+    }
+    else
+    {
+        Out.FootprintTables.Reset();
+    }
+
+    // --- Horde spawn zones ---
+    if (bBuildSpawnZones)
+    {
+        FTerrainSpawnZoneSettings SpawnSettings;
+        SpawnSettings.MaxSlopeDeg = SpawnMaxSlopeDeg;
+        SpawnSettings.WaterClearance = SpawnWaterClearance;
+        SpawnSettings.EdgeBand = SpawnEdgeBand;
+        SpawnSettings.MinBaseDistance = SpawnMinBaseDistance;
+        SpawnSettings.NumZones = NumSpawnZones;
+        Out.SpawnZones.Build(Heights, OutNormals, NumQuadsX, NumQuadsY, GridSpacing, WaterZ,
+            bEnableFlatten ? FlattenCenter : FVector2D::ZeroVector, SpawnSettings);
+    }
+    else
+    {
+        Out.SpawnZones.Reset();
+    }
+
+
+    // --- Simple tangents (+X). Good for most world-aligned materials. ---
+    OutTangents.SetNumUninitialized(TotalVerts, EAllowShrinking::No);
+    for (int32 i = 0; i < TotalVerts; ++i)
+    {
+        OutTangents[i] = FProcMeshTangent(1.f, 0.f, 0.f);
+    }
+
+    // --- Material blend weights -> vertex colors ---
+    if (bBakeBlendWeights)
+    {
+        OutColors.SetNumUninitialized(TotalVerts, EAllowShrinking::No);
+        BakeBlendWeights(Heights, Out.WaterMap, FIntRect(0, 0, NumQuadsX, NumQuadsY), OutNormals.GetData(), OutColors.GetData());
+    }
+    else
+    {
+        OutColors.Reset();
+    }
+}
+
+
+FVector ANoiseTerrainActor::GridNormalAt(const TArray<float>& Heights, int32 X, int32 Y) const
+{
+    const int32 VertsX = NumQuadsX + 1;
+
+    // World noise continues past our edges, so border vertices also sum the neighbour's quads and
+    // get the same normal on both sides of the seam
+    const bool bSampleOutside = NoiseSpace == ETerrainNoiseSpace::World;
+    auto P = [this, &Heights, VertsX](int32 x, int32 y)
+    {
+        if (x < 0 || y < 0 || x > NumQuadsX || y > NumQuadsY)
+        {
+            const float Outside = SampleHeightAtIndex(x, y, (x - NumQuadsX * 0.5f) * GridSpacing, (y - NumQuadsY * 0.5f) * GridSpacing);
+            return FVector(x * GridSpacing, y * GridSpacing, Outside);
+        }
+        return FVector(x * GridSpacing, y * GridSpacing, Heights[CacheIndex(x, y, VertsX)]);
+    };
+
+    // Sum the (area-weighted) faces of the up to four quads around the vertex that touch it
+    FVector N = FVector::ZeroVector;
+    for (int32 qy = Y - 1; qy <= Y; ++qy)
+    {
+        for (int32 qx = X - 1; qx <= X; ++qx)
+        {
+            if (!bSampleOutside && (qx < 0 || qy < 0 || qx >= NumQuadsX || qy >= NumQuadsY)) continue;
+
+            const bool b00 = (X == qx && Y == qy);
+            const bool b10 = (X == qx + 1 && Y == qy);
+            const bool b01 = (X == qx && Y == qy + 1);
+            const bool b11 = (X == qx + 1 && Y == qy + 1);
+
+            const FVector P00 = P(qx, qy);
+            const FVector P11 = P(qx + 1, qy + 1);
+
+            // Triangles (v00, v11, v10) and (v00, v01, v11), as in GenerateGrid
+            if (b00 || b11 || b10)
+            {
+                N += FVector::CrossProduct(P(qx + 1, qy) - P00, P11 - P00);
+            }
+            if (b00 || b01 || b11)
+            {
+                N += FVector::CrossProduct(P11 - P00, P(qx, qy + 1) - P00);
+            }
+        }
+    }
+
+    const double Len2 = N.SizeSquared();
+    return (Len2 < 1e-12) ? FVector::UpVector : N / FMath::Sqrt(Len2);
+}
+
+void ANoiseTerrainActor::ComputeGridNormals(const TArray<float>& Heights, TArray<FVector>& OutNormals) const
+{
+    const int32 VertsX = NumQuadsX + 1;
+    const int32 VertsY = NumQuadsY + 1;
+    OutNormals.SetNumUninitialized(VertsX * VertsY, EAllowShrinking::No);
+
+    ParallelFor(VertsY, [this, &Heights, VertsX, &OutNormals](int32 y)
+    {
+        for (int32 x = 0; x < VertsX; ++x)
+        {
+            OutNormals[CacheIndex(x, y, VertsX)] = GridNormalAt(Heights, x, y);
+        }
+    });
+}
+
+
+void ANoiseTerrainActor::BakeBlendWeights(const TArray<float>& Heights, const FTerrainWaterMap& Water, const FIntRect& Rect,
+    const FVector* Normals, FColor* OutColors) const
+{
+    const int32 VertsX = NumQuadsX + 1;
+    const int32 RectW = Rect.Width() + 1;
+    const float HalfW = NumQuadsX * GridSpacing * 0.5f;
+    const float HalfH = NumQuadsY * GridSpacing * 0.5f;
+
+    const FBlendWeightRamps Ramps = GetBlendWeightRamps();
+    const bool bHasWater = Water.IsValid() && Water.GetNumBodies() > 0;
+
+    ParallelFor(Rect.Height() + 1, [&](int32 Row)
+    {
+        const int32 y = Rect.Min.Y + Row;
+        const float LocalY = y * GridSpacing - HalfH;
+        for (int32 x = Rect.Min.X; x <= Rect.Max.X; ++x)
+        {
+            const int32 i = CacheIndex(x, y, VertsX);
+            const int32 r = Row * RectW + (x - Rect.Min.X);
+
+            const float Shore = bHasWater
+                ? 1.f - Smoothstep01(Water.GetShoreDistanceAt(x, y) * Ramps.InvShoreWidth)
+                : 0.f;
+            const float Pad = FlattenWeightAtLocalXY(x * GridSpacing - HalfW, LocalY);
+
+            OutColors[r] = BlendWeightsAt(Ramps, (float)Normals[r].Z, Heights[i], Shore, Pad);
+        }
+    });
+}
+
+ANoiseTerrainActor::FBlendWeightRamps ANoiseTerrainActor::GetBlendWeightRamps() const
+{
+    // Compare normal Z against cosines instead of taking acos per vertex
+    FBlendWeightRamps Ramps;
+    Ramps.CosSlopeStart = FMath::Cos(FMath::DegreesToRadians(FMath::Min(BlendSlopeStartDeg, BlendSlopeEndDeg)));
+    const float CosSlopeEnd = FMath::Cos(FMath::DegreesToRadians(FMath::Max(BlendSlopeStartDeg, BlendSlopeEndDeg)));
+    Ramps.InvSlopeRange = 1.f / FMath::Max(Ramps.CosSlopeStart - CosSlopeEnd, KINDA_SMALL_NUMBER);
+    Ramps.InvHeightRange = 1.f / FMath::Max(BlendHeightHigh - BlendHeightLow, KINDA_SMALL_NUMBER);
+    Ramps.InvShoreWidth = 1.f / FMath::Max(BlendShoreWidth, 1.f);
+    return Ramps;
+}
+
+FColor ANoiseTerrainActor::BlendWeightsAt(const FBlendWeightRamps& Ramps, float NormalZ, float Height, float Shore, float Pad) const
+{
+    const float Slope = Smoothstep01((Ramps.CosSlopeStart - NormalZ) * Ramps.InvSlopeRange);
+    const float Band = Smoothstep01((Height - BlendHeightLow) * Ramps.InvHeightRange);
+
+    return FColor(
+        (uint8)FMath::RoundToInt(Slope * 255.f),
+        (uint8)FMath::RoundToInt(Band * 255.f),
+        (uint8)FMath::RoundToInt(Shore * 255.f),
+        (uint8)FMath::RoundToInt(Pad * 255.f));
+}
+
+
+void ANoiseTerrainActor::BuildCompactMeshData(const TArray<float>& Heights, const TArray<FVector>& Normals, const TArray<FColor>& Colors,
+    FTerrainMeshData& Data) const
+{
+    // Refilled in place (no reset-assign) so Data's arrays keep the capacity of the last build
+    Data.NumQuadsX = NumQuadsX;
+    Data.NumQuadsY = NumQuadsY;
+    Data.GridSpacing = GridSpacing;
+    Data.TileQuads = RenderTileQuads;
+
+    Data.Heights.SetNumUninitialized(Heights.Num(), EAllowShrinking::No);
+    FMemory::Memcpy(Data.Heights.GetData(), Heights.GetData(), Heights.Num() * sizeof(float));
+
+    Data.Normals.SetNumUninitialized(Normals.Num(), EAllowShrinking::No);
+    for (int32 i = 0; i < Normals.Num(); ++i)
+    {
+        Data.Normals[i] = FPackedNormal(FVector3f(Normals[i]));
+    }
+
+    Data.Colors.SetNumUninitialized(Colors.Num(), EAllowShrinking::No);
+    if (Colors.Num() > 0)
+    {
+        FMemory::Memcpy(Data.Colors.GetData(), Colors.GetData(), Colors.Num() * sizeof(FColor));
+    }
+    Data.RecomputeBounds();
+}
+
+void ANoiseTerrainActor::CommitCompactMesh(FTerrainMeshData& Data)
+{
+    // Data gets the component's previous buffers back, ready for the next build
+    TerrainMesh->SwapMeshData(Data);
+    TerrainMesh->SetMaterial(0, TerrainMaterial);
+
+    UE_LOG(LogTemp, Verbose, TEXT("NoiseTerrain: compact mesh %d tiles, %.2f MB GPU"),
+        TerrainMesh->GetMeshData().GetTilesX() * TerrainMesh->GetMeshData().GetTilesY(),
+        TerrainMesh->GetGPUMemoryBytes() / (1024.0 * 1024.0));
+}
+
+
+void ANoiseTerrainActor::BuildHeightCache(TArray<float>& Heights, int32 VertsX, int32 VertsY)
+{
+    const float HalfW = NumQuadsX * GridSpacing * 0.5f;
+    const float HalfH = NumQuadsY * GridSpacing * 0.5f;
+
+    // Only eroded heights are worth caching; raw noise is cheaper to resample than to load
+    const uint64 Hash = (bEnableErosion && bCacheErodedHeights) ? GetGenerationHash() : 0;
+    if (Hash != 0 && LoadCachedHeights(Hash, Heights, VertsX, VertsY))
+    {
+        return;
+    }
+
+    Heights.SetNumUninitialized(VertsX * VertsY, EAllowShrinking::No);
+
+    // --- Heights: index-space sampling for smooth, small hills ---
+    // Decouples noise frequency from centimeters; avoids "flat at spacing=200" issue.
+    // Rows are independent and the noise is read-only here, so sample them in parallel.
+    ParallelFor(VertsY, [this, &Heights, VertsX, HalfW, HalfH](int32 y)
+    {
+        const float LocalY = y * GridSpacing - HalfH;
+        for (int32 x = 0; x < VertsX; ++x)
+        {
+            const float LocalX = x * GridSpacing - HalfW;  // centered
+            Heights[CacheIndex(x, y, VertsX)] = SampleHeightAtIndex(x, y, LocalX, LocalY);
+        }
+    });
+
+    if (bEnableErosion)
+    {
+        const double StartSeconds = FPlatformTime::Seconds();
+
+        if (NoiseSpace == ETerrainNoiseSpace::World)
+        {
+            ErodeWithApron(Heights, VertsX, VertsY);
+        }
+        else
+        {
+            FTerrainErosion::Erode(Heights, VertsX, VertsY, GridSpacing, Seed, Erosion, Scratch.Erosion);
+        }
+
+        // Water carves into the pad too; blend it back to exactly FlattenHeight
+        if (bEnableFlatten)
+        {
+            ParallelFor(VertsY, [this, &Heights, VertsX, HalfW, HalfH](int32 y)
+            {
+                const float LocalY = y * GridSpacing - HalfH;
+                for (int32 x = 0; x < VertsX; ++x)
+                {
+                    const float w = FlattenWeightAtLocalXY(x * GridSpacing - HalfW, LocalY);
+                    if (w <= 0.f) continue;
+
+                    float& H = Heights[CacheIndex(x, y, VertsX)];
+                    H = FMath::Lerp(H, FlattenHeight, w);
+                }
+            });
+        }
+
+        UE_LOG(LogTemp, Log, TEXT("NoiseTerrain: eroded %dx%d in %.1f ms"),
+            VertsX, VertsY, (FPlatformTime::Seconds() - StartSeconds) * 1000.0);
+
+        if (Hash != 0)
+        {
+            SaveCachedHeights(Hash, Heights, VertsX, VertsY);
+        }
+    }
+}
+
+void ANoiseTerrainActor::ErodeWithApron(TArray<float>& Heights, int32 VertsX, int32 VertsY)
+{
+    const int32 Apron = FMath::Max(WorldErosionApron, 0);
+    const int32 PadX = VertsX + 2 * Apron;
+    const int32 PadY = VertsY + 2 * Apron;
+
+    const float HalfW = NumQuadsX * GridSpacing * 0.5f;
+    const float HalfH = NumQuadsY * GridSpacing * 0.5f;
+
+    // Our raw heights, surrounded by the same world noise the neighbours sample
+    TArray<float>& Padded = Scratch.ApronHeights;
+    Padded.SetNumUninitialized(PadX * PadY, EAllowShrinking::No);
+    ParallelFor(PadY, [this, &Heights, &Padded, Apron, PadX, VertsX, VertsY, HalfW, HalfH](int32 py)
+    {
+        const int32 iy = py - Apron;
+        for (int32 px = 0; px < PadX; ++px)
+        {
+            const int32 ix = px - Apron;
+            const bool bInside = ix >= 0 && iy >= 0 && ix < VertsX && iy < VertsY;
+            Padded[py * PadX + px] = bInside
+                ? Heights[CacheIndex(ix, iy, VertsX)]
+                : SampleHeightAtIndex(ix, iy, ix * GridSpacing - HalfW, iy * GridSpacing - HalfH);
+        }
+    });
+
+    FTerrainErosion::Erode(Padded, PadX, PadY, GridSpacing, Seed, Erosion, Scratch.Erosion);
+
+    // Each actor erodes its own apron differently, so only pure noise can be shared: blend from raw at
+    // the outer two rows (the border and the row its normals read) to fully eroded FadeQuads further in
+    const float FadeQuads = (float)FMath::Max(WorldErosionEdgeFade, 1);
+    ParallelFor(VertsY, [this, &Heights, &Padded, Apron, PadX, VertsX, FadeQuads](int32 y)
+    {
+        for (int32 x = 0; x < VertsX; ++x)
+        {
+            const int32 EdgeDist = FMath::Min(FMath::Min(x, NumQuadsX - x), FMath::Min(y, NumQuadsY - y));
+            const float w = FMath::Clamp((EdgeDist - 1) / FadeQuads, 0.f, 1.f);
+
+            float& H = Heights[CacheIndex(x, y, VertsX)];
+            H = FMath::Lerp(H, Padded[(y + Apron) * PadX + (x + Apron)], w);
+        }
+    });
+}
+
+void ANoiseTerrainActor::UpdateNoiseGridOrigin()
+{
+    NoiseGridOrigin = FIntPoint::ZeroValue;
+    if (NoiseSpace != ETerrainNoiseSpace::World) return;
+
+    const FTransform& T = GetActorTransform();
+    if (!T.GetRotation().IsIdentity(1e-4) || !T.GetScale3D().Equals(FVector::OneVector, 1e-4))
+    {
+        UE_LOG(LogTemp, Warning, TEXT("NoiseTerrain: %s uses world noise but is rotated or scaled; it won't line up with its neighbours."),
+            *GetName());
+    }
+
+    // World-grid index of our (0,0) corner
+    const double CornerX = (T.GetLocation().X - NumQuadsX * GridSpacing * 0.5) / GridSpacing;
+    const double CornerY = (T.GetLocation().Y - NumQuadsY * GridSpacing * 0.5) / GridSpacing;
+    NoiseGridOrigin = FIntPoint(FMath::RoundToInt(CornerX), FMath::RoundToInt(CornerY));
+
+    if (!FMath::IsNearlyEqual(CornerX, (double)NoiseGridOrigin.X, 1e-3) || !FMath::IsNearlyEqual(CornerY, (double)NoiseGridOrigin.Y, 1e-3))
+    {
+        UE_LOG(LogTemp, Warning, TEXT("NoiseTerrain: %s is off the world grid; move it to X=%.1f Y=%.1f to share borders."),
+            *GetName(),
+            (NoiseGridOrigin.X + NumQuadsX * 0.5) * GridSpacing,
+            (NoiseGridOrigin.Y + NumQuadsY * 0.5) * GridSpacing);
+    }
+}
+
+uint64 ANoiseTerrainActor::GetGenerationHash() const
+{
+    // Serialize every input of BuildHeightCache and hash the blob; the worker and the game thread both
+    // hash, so each keeps its own blob across calls
+    static thread_local TArray<uint8> Blob;
+    Blob.Reset();
+    FMemoryWriter Ar(Blob);
+    auto Put = [&Ar](auto Value) { Ar << Value; };
+
+    Put(HeightCacheVersion);
+    Put(NumQuadsX); Put(NumQuadsY); Put(GridSpacing);
+    Put(HeightAmplitude); Put(Octaves); Put(Lacunarity); Put(Persistence);
+    Put(Seed); Put(FeatureScale); Put(NoiseOffset);
+    Put((uint8)NoiseSpace); Put(NoiseGridOrigin);
+
+    Put(bEnableFlatten);
+    if (bEnableFlatten)
+    {
+        Put(FlattenCenter); Put(FlattenSize); Put(FlattenHeight); Put(FlattenFalloff);
+    }
+
+    Put(bEnableErosion);
+    if (bEnableErosion)
+    {
+        Put(Erosion.Iterations);
+        Put(Erosion.DropletsPerCell); Put(Erosion.DropletLifetime); Put(Erosion.Inertia);
+        Put(Erosion.SedimentCapacity); Put(Erosion.MinSedimentCapacity);
+        Put(Erosion.ErodeSpeed); Put(Erosion.DepositSpeed); Put(Erosion.EvaporateSpeed);
+        Put(Erosion.Gravity); Put(Erosion.BrushRadius);
+        Put(Erosion.ThermalStepsPerIteration); Put(Erosion.TalusAngleDeg); Put(Erosion.ThermalRate);
+        if (NoiseSpace == ETerrainNoiseSpace::World)
+        {
+            Put(WorldErosionApron); Put(WorldErosionEdgeFade);
+        }
+    }
+
+    return CityHash64(reinterpret_cast<const char*>(Blob.GetData()), Blob.Num());
+}
+
+FString ANoiseTerrainActor::GetHeightCachePath(uint64 Hash) const
+{
+    return FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("TerrainCache"),
+        FString::Printf(TEXT("%016llx.height"), Hash));
+}
+
+bool ANoiseTerrainActor::LoadCachedHeights(uint64 Hash, TArray<float>& Heights, int32 VertsX, int32 VertsY)
+{
+    TArray<uint8>& Bytes = Scratch.FileBytes;
+    if (!FFileHelper::LoadFileToArray(Bytes, *GetHeightCachePath(Hash), FILEREAD_Silent))
+    {
+        return false;
+    }
+
+    FMemoryReader Ar(Bytes);
+    uint32 Magic = 0;
+    int32 Version = 0;
+    uint64 StoredHash = 0;
+    int32 X = 0, Y = 0;
+    Ar << Magic << Version << StoredHash << X << Y;
+
+    const int64 PayloadBytes = (int64)VertsX * VertsY * sizeof(float);
+    if (Ar.IsError() || Magic != HeightCacheMagic || Version != HeightCacheVersion ||
+        StoredHash != Hash || X != VertsX || Y != VertsY || Ar.TotalSize() - Ar.Tell() != PayloadBytes)
+    {
+        return false;
+    }
+
+    Heights.SetNumUninitialized(VertsX * VertsY, EAllowShrinking::No);
+    Ar.Serialize(Heights.GetData(), PayloadBytes);
+    return !Ar.IsError();
+}
+
+void ANoiseTerrainActor::SaveCachedHeights(uint64 Hash, const TArray<float>& Heights, int32 VertsX, int32 VertsY)
+{
+    TArray<uint8>& Bytes = Scratch.FileBytes;
+    Bytes.Reset();
+    Bytes.Reserve(32 + Heights.Num() * sizeof(float));
+    FMemoryWriter Ar(Bytes);
+
+    uint32 Magic = HeightCacheMagic;
+    int32 Version = HeightCacheVersion;
+    int32 X = VertsX, Y = VertsY;
+    Ar << Magic << Version << Hash << X << Y;
+    Ar.Serialize(const_cast<float*>(Heights.GetData()), Heights.Num() * sizeof(float));
+
+    if (!FFileHelper::SaveArrayToFile(Bytes, *GetHeightCachePath(Hash)))
+    {
+        UE_LOG(LogTemp, Warning, TEXT("NoiseTerrain: failed to write height cache %s"), *GetHeightCachePath(Hash));
+    }
+}
+
+void ANoiseTerrainActor::SetDebugOverlay(ETerrainDebugOverlay Mode)
+{
+    DebugOverlay = Mode;
+    RefreshDebugOverlay();
+}
+
+void ANoiseTerrainActor::SetScatterRejections(const FScatterRejectionMap& Rejections)
+{
+    ScatterRejections = Rejections;
+    if (DebugOverlay == ETerrainDebugOverlay::ScatterRejections)
+    {
+        RefreshDebugOverlay();
+    }
+}
+
+void ANoiseTerrainActor::RefreshDebugOverlay()
+{
+    if (!DebugOverlayMesh) return;
+
+    const FTerrainSnapshotPtr Ground = GetSnapshot();
+    if (DebugOverlay == ETerrainDebugOverlay::None || !Ground.IsValid() || !Ground->IsValid())
+    {
+        DebugOverlayMesh->ClearMeshData();
+        DebugOverlayMesh->SetVisibility(false);
+        return;
+    }
+
+    FTerrainDebugOverlaySettings Settings;
+    Settings.Mode = DebugOverlay;
+    Settings.Stride = DebugOverlayStride;
+    Settings.TileQuads = RenderTileQuads;
+    Settings.SlopeBandDeg = DebugSlopeBandDeg;
+    Settings.HeightBandSize = DebugHeightBandSize;
+    Settings.NavMaxSlopeDeg = DebugNavMaxSlopeDeg;
+
+    FTerrainMeshData& Data = DebugOverlayData;
+    FTerrainDebugOverlay::Build(*Ground, Settings, &ScatterRejections, Data);
+
+    // The overlay grid is centered on its own (possibly overhanging) extent; line its samples up with ours
+    const float OffsetX = 0.5f * (Data.NumQuadsX * Data.GridSpacing - NumQuadsX * GridSpacing);
+    const float OffsetY = 0.5f * (Data.NumQuadsY * Data.GridSpacing - NumQuadsY * GridSpacing);
+    DebugOverlayMesh->SetRelativeLocation(FVector(OffsetX, OffsetY, DebugOverlayLift));
+
+    DebugOverlayMesh->SwapMeshData(Data);
+    DebugOverlayMesh->SetMaterial(0, DebugOverlayMaterial ? DebugOverlayMaterial : (GEngine ? GEngine->VertexColorMaterial : nullptr));
+    DebugOverlayMesh->SetVisibility(true);
+}
+
+void ANoiseTerrainActor::BuildCollisionTiles(const FIntRect* CookFirstRect)
+{
+    const int32 TileQuads = FMath::Max(CollisionTileQuads, 1);
+    const int32 TilesX = FMath::DivideAndRoundUp(NumQuadsX, TileQuads);
+    const int32 TilesY = FMath::DivideAndRoundUp(NumQuadsY, TileQuads);
+    const int32 NumTiles = TilesX * TilesY;
+
+    const float HalfW = NumQuadsX * GridSpacing * 0.5f;
+    const float HalfH = NumQuadsY * GridSpacing * 0.5f;
+
+    // Reuse the components from the last build; only create/destroy the difference
+    CollisionTiles.RemoveAll([](const UProceduralMeshComponent* C) { return !IsValid(C); });
+    while (CollisionTiles.Num() > NumTiles)
+    {
+        CollisionTiles.Pop()->DestroyComponent();
+    }
+    while (CollisionTiles.Num() < NumTiles)
+    {
+        UProceduralMeshComponent* Tile = NewObject<UProceduralMeshComponent>(this, NAME_None, RF_Transient);
+        Tile->bUseAsyncCooking = true;
+        Tile->SetVisibility(false);   // collision only, never rendered
+        Tile->SetCastShadow(false);
+        Tile->SetupAttachment(ProcMesh);
+        Tile->RegisterComponent();
+        CollisionTiles.Add(Tile);
+    }
+
+    CollisionTilesX = TilesX;
+    CollisionTilesY = TilesY;
+    NumCollisionTilesReady = 0;
+    CollisionTileReady.Init(false, NumTiles);
+    CollisionTileDirty.Init(false, NumTiles);
+    CollisionTileSubmittedOver.Reset();
+    CollisionTileSubmittedOver.SetNum(NumTiles);
+    CollisionCooking.Reset();
+    CollisionCookCursor = 0;
+
+    // Cook order: closest to the pad or the player first, so play can start before the far edges are done
+    TArray<FVector2D, TInlineAllocator<2>> Focus;
+    if (bEnableFlatten)
+    {
+        Focus.Add(FlattenCenter);
+    }
+    if (const APlayerController* PC = GetWorld() ? GetWorld()->GetFirstPlayerController() : nullptr)
+    {
+        if (const APawn* Pawn = PC->GetPawn())
+        {
+            const FVector L = GetActorTransform().InverseTransformPosition(Pawn->GetActorLocation());
+            Focus.Add(FVector2D(L.X, L.Y));
+        }
+    }
+    if (Focus.Num() == 0)
+    {
+        Focus.Add(FVector2D::ZeroVector);
+    }
+
+    TArray<float>& TileDist2 = Scratch.TileDist2;
+    TileDist2.SetNumUninitialized(NumTiles, EAllowShrinking::No);
+    CollisionCookQueue.SetNumUninitialized(NumTiles);
+    for (int32 TileIndex = 0; TileIndex < NumTiles; ++TileIndex)
+    {
+        const FVector2D Center(
+            ((TileIndex % TilesX) + 0.5f) * TileQuads * GridSpacing - HalfW,
+            ((TileIndex / TilesX) + 0.5f) * TileQuads * GridSpacing - HalfH);
+
+        float Best = FLT_MAX;
+        for (const FVector2D& F : Focus)
+        {
+            Best = FMath::Min(Best, (float)FVector2D::DistSquared(Center, F));
+        }
+        TileDist2[TileIndex] = Best;
+        CollisionCookQueue[TileIndex] = TileIndex;
+
+        // Tile vertices are [T * TileQuads, (T + 1) * TileQuads]
+        if (CookFirstRect)
+        {
+            const int32 TX = TileIndex % TilesX;
+            const int32 TY = TileIndex / TilesX;
+            if (TX * TileQuads <= CookFirstRect->Max.X && (TX + 1) * TileQuads >= CookFirstRect->Min.X &&
+                TY * TileQuads <= CookFirstRect->Max.Y && (TY + 1) * TileQuads >= CookFirstRect->Min.Y)
+            {
+                TileDist2[TileIndex] = -1.f;
+            }
+        }
+    }
+    CollisionCookQueue.Sort([&TileDist2](int32 A, int32 B) { return TileDist2[A] < TileDist2[B]; });
+
+    PumpCollisionCooking();
+    if (HasPendingCollisionCooks())
+    {
+        SetActorTickEnabled(true);
+    }
+}
+
+void ANoiseTerrainActor::SubmitCollisionTile(int32 TileIndex)
+{
+    const int32 VertsX = NumQuadsX + 1;
+    const int32 TileQuads = FMath::Max(CollisionTileQuads, 1);
+    const int32 Stride = FMath::Clamp(CollisionStride, 1, TileQuads);
+
+    const float HalfW = NumQuadsX * GridSpacing * 0.5f;
+    const float HalfH = NumQuadsY * GridSpacing * 0.5f;
+
+    const int32 TX = TileIndex % CollisionTilesX;
+    const int32 TY = TileIndex / CollisionTilesX;
+
+    // Every Stride-th line plus the tile's last line, so neighbouring tiles share border vertices
+    auto Lines = [Stride](int32 First, int32 Last, TArray<int32>& Out)
+    {
+        Out.Reset();
+        for (int32 i = First; i < Last; i += Stride) Out.Add(i);
+        Out.Add(Last);
+    };
+
+    TArray<int32>& Xs = Scratch.LinesX;
+    TArray<int32>& Ys = Scratch.LinesY;
+    Lines(TX * TileQuads, FMath::Min((TX + 1) * TileQuads, NumQuadsX), Xs);
+    Lines(TY * TileQuads, FMath::Min((TY + 1) * TileQuads, NumQuadsY), Ys);
+
+    TArray<FVector>& V = Scratch.Vertices;
+    V.Reset();
+    V.Reserve(Xs.Num() * Ys.Num());
+    for (const int32 y : Ys)
+    {
+        for (const int32 x : Xs)
+        {
+            V.Add(FVector(x * GridSpacing - HalfW, y * GridSpacing - HalfH, HeightCache[CacheIndex(x, y, VertsX)]));
+        }
+    }
+
+    TArray<int32>& I = Scratch.Indices;
+    I.Reset();
+    I.Reserve((Xs.Num() - 1) * (Ys.Num() - 1) * 6);
+    for (int32 y = 0; y < Ys.Num() - 1; ++y)
+    {
+        for (int32 x = 0; x < Xs.Num() - 1; ++x)
+        {
+            const int32 v00 = y * Xs.Num() + x;
+            const int32 v10 = v00 + 1;
+            const int32 v01 = v00 + Xs.Num();
+            const int32 v11 = v01 + 1;
+
+            // Same winding as the render grid (+Z)
+            I.Add(v00); I.Add(v11); I.Add(v10);
+            I.Add(v00); I.Add(v01); I.Add(v11);
+        }
+    }
+
+    UProceduralMeshComponent* Tile = CollisionTiles[TileIndex];
+    CollisionTileSubmittedOver[TileIndex] = Tile->GetBodySetup();
+
+    Tile->SetCollisionProfileName(ProcMesh->GetCollisionProfileName());
+    Tile->CreateMeshSection_LinearColor(0, V, I, TArray<FVector>(), TArray<FVector2D>(),
+        TArray<FLinearColor>(), TArray<FProcMeshTangent>(), /*bCreateCollision=*/true);
+    Tile->SetMeshSectionVisible(0, false);
+}
+
+bool ANoiseTerrainActor::IsCollisionTileCooked(int32 TileIndex)
+{
+    // ProcMesh swaps in a fresh body setup when its async cook finishes
+    UProceduralMeshComponent* Tile = CollisionTiles[TileIndex];
+    if (!IsValid(Tile)) return false;
+
+    const UBodySetup* Current = Tile->GetBodySetup();
+    return Current && Current != CollisionTileSubmittedOver[TileIndex].Get() && Current->bCreatedPhysicsMeshes;
+}
+
+void ANoiseTerrainActor::MarkCollisionTileReady(int32 TileIndex)
+{
+    if (CollisionTileReady[TileIndex]) return;
+
+    CollisionTileReady[TileIndex] = true;
+    ++NumCollisionTilesReady;
+    OnCollisionTileReady.Broadcast(TileIndex);
+
+    if (NumCollisionTilesReady == CollisionTileReady.Num())
+    {
+        if (bDeformCollisionTiled)
+        {
+            DropFullMeshCollision();
+        }
+        OnCollisionReady.Broadcast();
+    }
+}
+
+bool ANoiseTerrainActor::HasPendingCollisionCooks() const
+{
+    return CollisionCooking.Num() > 0 || CollisionCookCursor < CollisionCookQueue.Num();
+}
+
+void ANoiseTerrainActor::PumpCollisionCooking()
+{
+    // Outside game worlds ProcMesh cooks synchronously, so a submitted tile is already done
+    const bool bAsyncCook = GetWorld() && GetWorld()->IsGameWorld();
+
+    for (int32 i = CollisionCooking.Num() - 1; i >= 0; --i)
+    {
+        const int32 TileIndex = CollisionCooking[i];
+        if (IsCollisionTileCooked(TileIndex))
+        {
+            CollisionCooking.RemoveAtSwap(i);
+            MarkCollisionTileReady(TileIndex);
+
+            if (CollisionTileDirty[TileIndex])
+            {
+                CollisionTileDirty[TileIndex] = false;
+                QueueCollisionRecook(TileIndex);
+            }
+        }
+    }
+
+    const int32 MaxInFlight = FMath::Max(MaxConcurrentCollisionCooks, 1);
+    int32 SubmittedThisPump = 0;
+    while (CollisionCookCursor < CollisionCookQueue.Num() &&
+           CollisionCooking.Num() < MaxInFlight && SubmittedThisPump < MaxInFlight)
+    {
+        const int32 TileIndex = CollisionCookQueue[CollisionCookCursor++];
+        if (!IsValid(CollisionTiles[TileIndex])) continue;
+
+        SubmitCollisionTile(TileIndex);
+        ++SubmittedThisPump;
+
+        if (bAsyncCook)
+        {
+            CollisionCooking.Add(TileIndex);
+        }
+        else
+        {
+            MarkCollisionTileReady(TileIndex);
+        }
+    }
+}
+
+void ANoiseTerrainActor::ClearCollisionTiles()
+{
+    for (UProceduralMeshComponent* Tile : CollisionTiles)
+    {
+        if (IsValid(Tile)) Tile->DestroyComponent();
+    }
+    CollisionTiles.Reset();
+
+    CollisionTilesX = CollisionTilesY = 0;
+    NumCollisionTilesReady = 0;
+    CollisionTileReady.Reset();
+    CollisionTileDirty.Reset();
+    CollisionTileSubmittedOver.Reset();
+    CollisionCookQueue.Reset();
+    CollisionCookCursor = 0;
+    CollisionCooking.Reset();
+}
+
+void ANoiseTerrainActor::QueueCollisionRecook(int32 TileIndex)
+{
+    // The tile keeps its old collision (and stays "ready") until the new cook swaps in
+    if (CollisionCooking.Contains(TileIndex))
+    {
+        CollisionTileDirty[TileIndex] = true;
+        return;
+    }
+
+    if (CollisionCookCursor == CollisionCookQueue.Num())
+    {
+        CollisionCookQueue.Reset();
+        CollisionCookCursor = 0;
+    }
+
+    // Edited tiles go next, ahead of any initial cook still queued behind them
+    for (int32 i = CollisionCookCursor; i < CollisionCookQueue.Num(); ++i)
+    {
+        if (CollisionCookQueue[i] == TileIndex)
+        {
+            CollisionCookQueue.RemoveAt(i, 1, EAllowShrinking::No);
+            break;
+        }
+    }
+    CollisionCookQueue.Insert(TileIndex, CollisionCookCursor);
+}
+
+bool ANoiseTerrainActor::IsCollisionReadyAtWorldXY(float WorldX, float WorldY) const
+{
+    if (!bCreateCollision || CollisionMode == ETerrainCollisionMode::None) return false;
+    if (CollisionMode == ETerrainCollisionMode::FullMesh) return true;
+    if (CollisionTilesX == 0) return false;
+
+    float U, V;
+    WorldToGrid(WorldX, WorldY, U, V);
+
+    const int32 TileQuads = FMath::Max(CollisionTileQuads, 1);
+    const int32 TX = FMath::Min((int32)U / TileQuads, CollisionTilesX - 1);
+    const int32 TY = FMath::Min((int32)V / TileQuads, CollisionTilesY - 1);
+    return CollisionTileReady[TY * CollisionTilesX + TX];
+}
+
+float ANoiseTerrainActor::GetCollisionReadyFraction() const
+{
+    if (!bCreateCollision || CollisionMode == ETerrainCollisionMode::None) return 0.f;
+    if (CollisionMode == ETerrainCollisionMode::FullMesh) return 1.f;
+    return CollisionTileReady.Num() > 0 ? (float)NumCollisionTilesReady / (float)CollisionTileReady.Num() : 0.f;
+}
+
+void ANoiseTerrainActor::ApplyCrater(FVector WorldCenter, float Radius, float Depth)
+{
+    ApplyRadialHeightEdit(WorldCenter, Radius, [Radius, Depth](float Dist, float Height)
+    {
+        const float t = Dist / Radius;
+        return Height - Depth * FMath::Square(1.f - t * t);
+    });
+}
+
+void ANoiseTerrainActor::FlattenTerrain(FVector WorldCenter, float Radius, float TargetWorldZ, float Falloff)
+{
+    const float TargetZ = (float)GetActorTransform().InverseTransformPosition(FVector(WorldCenter.X, WorldCenter.Y, TargetWorldZ)).Z;
+    const float Band = FMath::Max(Falloff, 1.f);
+
+    ApplyRadialHeightEdit(WorldCenter, Radius + Band, [Radius, Band, TargetZ](float Dist, float Height)
+    {
+        const float w = 1.f - Smoothstep01((Dist - Radius) / Band);
+        return FMath::Lerp(Height, TargetZ, w);
+    });
+}
+
+void ANoiseTerrainActor::ApplyRadialHeightEdit(const FVector& WorldCenter, float Radius, TFunctionRef<float(float Dist, float Height)> Edit)
+{
+    const int32 VertsX = NumQuadsX + 1;
+    if (!bCacheValid || HeightCache.Num() != VertsX * (NumQuadsY + 1) || Radius <= 0.f) return;
+
+    // The build in progress replaces these heights, and with them any edit made now
+    if (IsStagedBuildInProgress())
+    {
+        UE_LOG(LogTemp, Warning, TEXT("NoiseTerrain: %s ignored a height edit during a staged build."), *GetName());
+        return;
+    }
+
+    const float HalfW = NumQuadsX * GridSpacing * 0.5f;
+    const float HalfH = NumQuadsY * GridSpacing * 0.5f;
+
+    const FVector L = GetActorTransform().InverseTransformPosition(WorldCenter);
+    const float U = ((float)L.X + HalfW) / GridSpacing;
+    const float V = ((float)L.Y + HalfH) / GridSpacing;
+    const float R = Radius / GridSpacing;
 
-ANoiseTerrainActor::ANoiseTerrainActor()
-{
-    PrimaryActorTick.bCanEverTick = false;
+    const FIntRect Rect(
+        FMath::Max(FMath::CeilToInt(U - R), 0), FMath::Max(FMath::CeilToInt(V - R), 0),
+        FMath::Min(FMath::FloorToInt(U + R), NumQuadsX), FMath::Min(FMath::FloorToInt(V + R), NumQuadsY));
+    if (Rect.Min.X > Rect.Max.X || Rect.Min.Y > Rect.Max.Y) return;
 
-    ProcMesh = CreateDefaultSubobject<UProceduralMeshComponent>(TEXT("ProceduralMesh"));
-    ProcMesh->bUseAsyncCooking = true;
-    SetRootComponent(ProcMesh);
+    for (int32 y = Rect.Min.Y; y <= Rect.Max.Y; ++y)
+    {
+        const float DY = y * GridSpacing - HalfH - (float)L.Y;
+        for (int32 x = Rect.Min.X; x <= Rect.Max.X; ++x)
+        {
+            const float DX = x * GridSpacing - HalfW - (float)L.X;
+            const float Dist = FMath::Sqrt(DX * DX + DY * DY);
+            if (Dist > Radius) continue;
 
-    // Allocate the noise generator
-    NoisePtr = new FPerlinNoise(Seed);
-}
+            float& H = HeightCache[CacheIndex(x, y, VertsX)];
+            H = Edit(Dist, H);
+        }
+    }
 
-void ANoiseTerrainActor::OnConstruction(const FTransform& Transform)
-{
-    if (!NoisePtr) NoisePtr = new FPerlinNoise(Seed);
-    NoisePtr->reseed(Seed);
-    BuildMesh();
+    QueueDeformedRegion(Rect);
 }
 
-void ANoiseTerrainActor::Regenerate()
+void ANoiseTerrainActor::QueueDeformedRegion(const FIntRect& EditRect)
 {
-    if (!NoisePtr) NoisePtr = new FPerlinNoise(Seed);
-    NoisePtr->reseed(Seed);
-    BuildMesh();
-}
+    // Normals one vertex outside the edit change too
+    const FIntRect Rect(
+        FMath::Max(EditRect.Min.X - 1, 0), FMath::Max(EditRect.Min.Y - 1, 0),
+        FMath::Min(EditRect.Max.X + 1, NumQuadsX), FMath::Min(EditRect.Max.Y + 1, NumQuadsY));
 
-void ANoiseTerrainActor::BuildMesh()
-{
-    if (ProcMesh)
+    LastDeformEditTime = FPlatformTime::Seconds();
+    bHeightsDeformed = true;
+    ++HeightEditRevision;
+    bDeformSnapshotDirty = true;
+
+    if (FootprintTables.IsValid())
     {
-        ProcMesh->ClearAllMeshSections();
-        // If you ever add multiple sections, theyre gone now.
-        // Collision will be re-cooked by CreateMeshSection below.
+        bDeformFootprintDirty = true;
+        DeformFootprintRect = DeformFootprintRect.Max.X < DeformFootprintRect.Min.X
+            ? Rect
+            : FIntRect(DeformFootprintRect.Min.ComponentMin(Rect.Min), DeformFootprintRect.Max.ComponentMax(Rect.Max));
     }
 
-    TArray<FVector> Vertices;
-    TArray<int32> Triangles;
-    TArray<FVector> Normals;
-    TArray<FVector2D> UVs;
-    TArray<FProcMeshTangent> Tangents;
-
-    GenerateGrid(Vertices, Triangles, Normals, UVs, Tangents);
+    // Vertex x is in tiles (x - 1) / TQ .. x / TQ (tiles share their border line)
+    auto ForTilesInRect = [](const FIntRect& R, int32 TQ, int32 TilesX, int32 TilesY, auto&& Func)
+    {
+        const int32 TX0 = FMath::Max((R.Min.X - 1) / TQ, 0), TX1 = FMath::Min(R.Max.X / TQ, TilesX - 1);
+        const int32 TY0 = FMath::Max((R.Min.Y - 1) / TQ, 0), TY1 = FMath::Min(R.Max.Y / TQ, TilesY - 1);
+        for (int32 ty = TY0; ty <= TY1; ++ty)
+        {
+            for (int32 tx = TX0; tx <= TX1; ++tx)
+            {
+                Func(ty * TilesX + tx);
+            }
+        }
+    };
 
-    ProcMesh->CreateMeshSection_LinearColor(
-        0,
-        Vertices,
-        Triangles,
-        Normals,
-        UVs,
-        TArray<FLinearColor>(),
-        Tangents,
-        bCreateCollision
-    );
+    const FTerrainMeshData& Data = TerrainMesh->GetMeshData();
+    if (bUseCompactTerrainMesh && Data.IsValid())
+    {
+        const int32 TilesX = Data.GetTilesX();
+        const int32 TilesY = Data.GetTilesY();
+        if (DeformDirtyRects.Num() != TilesX * TilesY)
+        {
+            DeformDirtyRects.Init(EmptyDirtyRect, TilesX * TilesY);
+        }
 
-    if (TerrainMaterial)
+        ForTilesInRect(Rect, Data.GetTileQuads(), TilesX, TilesY, [this, &Rect, &Data](int32 Tile)
+        {
+            const FIntRect TileRect = Data.GetTileVertexRect(Tile);
+            const FIntRect Clip(
+                FMath::Max(Rect.Min.X, TileRect.Min.X), FMath::Max(Rect.Min.Y, TileRect.Min.Y),
+                FMath::Min(Rect.Max.X, TileRect.Max.X), FMath::Min(Rect.Max.Y, TileRect.Max.Y));
+            if (Clip.Min.X > Clip.Max.X || Clip.Min.Y > Clip.Max.Y) return;
+
+            FIntRect& Dirty = DeformDirtyRects[Tile];
+            if (Dirty.Max.X < Dirty.Min.X)
+            {
+                Dirty = Clip;
+                DeformTileQueue.Add(Tile);
+            }
+            else
+            {
+                Dirty.Min = Dirty.Min.ComponentMin(Clip.Min);
+                Dirty.Max = Dirty.Max.ComponentMax(Clip.Max);
+            }
+        });
+    }
+    else
     {
-        ProcMesh->SetMaterial(0, TerrainMaterial);
+        bDeformProcMeshDirty = true;
+        DeformProcMeshRect = DeformProcMeshRect.Max.X < DeformProcMeshRect.Min.X
+            ? Rect
+            : FIntRect(DeformProcMeshRect.Min.ComponentMin(Rect.Min), DeformProcMeshRect.Max.ComponentMax(Rect.Max));
     }
 
-    if (bShowSlab && bEnableFlatten)
+    if (bCreateCollision && CollisionMode == ETerrainCollisionMode::FullMesh && !bDeformCollisionTiled)
     {
-        BuildSlabSection(); // creates section 1, no collision
+        // Section 0 could only be re-cooked whole; tiles are cooked from the edited heights instead
+        BeginTiledDeformCollision(EditRect);
     }
-
-    // Water last so it renders on top where visible
-    if (bShowWater)
+    else if (bCreateCollision && CollisionTilesX > 0 &&
+        (CollisionMode == ETerrainCollisionMode::CoarseTiles || bDeformCollisionTiled))
     {
-        BuildWaterSection(); // creates section 2, no collision
+        ForTilesInRect(EditRect, FMath::Max(CollisionTileQuads, 1), CollisionTilesX, CollisionTilesY,
+            [this](int32 Tile) { QueueCollisionRecook(Tile); });
     }
 
-    DebugDrawNormals(Vertices, Normals);
+    SetActorTickEnabled(true);
 }
 
-
-void ANoiseTerrainActor::GenerateGrid(
-    TArray<FVector>& OutVertices,
-    TArray<int32>& OutTriangles,
-    TArray<FVector>& OutNormals,
-    TArray<FVector2D>& OutUVs,
-    TArray<FProcMeshTangent>& OutTangents
-)
+bool ANoiseTerrainActor::HasPendingDeformation() const
 {
-    check(NoisePtr);
+    return DeformTileCursor < DeformTileQueue.Num() || bDeformProcMeshDirty || bDeformFootprintDirty || bDeformSnapshotDirty;
+}
 
-    const int32 VertsX = NumQuadsX + 1;
-    const int32 VertsY = NumQuadsY + 1;
-    const int32 TotalVerts = VertsX * VertsY;
+void ANoiseTerrainActor::ProcessDeformation()
+{
+    const double StartSeconds = FPlatformTime::Seconds();
+    const double BudgetSeconds = FMath::Max(DeformationBudgetMs, 0.f) * 0.001;
 
-    const float HalfW = NumQuadsX * GridSpacing * 0.5f;
-    const float HalfH = NumQuadsY * GridSpacing * 0.5f;
+    // Render tiles first; at least one per tick so a tiny budget still makes progress
+    while (DeformTileCursor < DeformTileQueue.Num())
+    {
+        RefreshDeformedTile(DeformTileQueue[DeformTileCursor++]);
+        if (FPlatformTime::Seconds() - StartSeconds >= BudgetSeconds) return;
+    }
+    DeformTileQueue.Reset();
+    DeformTileCursor = 0;
 
-    OutVertices.SetNumUninitialized(TotalVerts);
-    OutUVs.SetNumUninitialized(TotalVerts);
-    HeightCache.SetNumUninitialized(VertsX * VertsY);
+    // The rest covers everything edited since it last ran, so it waits for a burst of edits to settle
+    if (FPlatformTime::Seconds() - LastDeformEditTime < DeformSettleSeconds) return;
 
-    // --- Heights: index-space sampling for smooth, small hills ---
-    // Decouples noise frequency from centimeters; avoids "flat at spacing=200" issue.
-    int32 Index = 0;
-    for (int32 y = 0; y < VertsY; ++y)
+    // Never re-cook section 0 whole: while it still collides, wait for the tiles to take over
+    if (bDeformProcMeshDirty && !HasFullMeshCollision())
     {
-        for (int32 x = 0; x < VertsX; ++x, ++Index)
-        {
-            const float LocalX = x * GridSpacing - HalfW;  // centered
-            const float LocalY = y * GridSpacing - HalfH;
+        bDeformProcMeshDirty = false;
+        const FIntRect Rect = DeformProcMeshRect;
+        DeformProcMeshRect = EmptyDirtyRect;
+        UpdateProcMeshFromCache(Rect);
+        return;
+    }
 
-            // Use the unified function
-            const float Height = SampleHeightAtIndex(x, y, LocalX, LocalY);
+    if (bDeformFootprintDirty)
+    {
+        bDeformFootprintDirty = false;
+        const FIntRect Rect = DeformFootprintRect;
+        DeformFootprintRect = EmptyDirtyRect;
 
-            OutVertices[Index] = FVector(LocalX, LocalY, Height);
-            OutUVs[Index] = FVector2D(
-                (float)x / (float)NumQuadsX,
-                (float)y / (float)NumQuadsY
-            );
-            HeightCache[Index] = Height;
+        // Only the edited vertices' normals changed
+        TArray<FVector>& Normals = Scratch.Normals;
+        if (FootprintTables.HasSlope())
+        {
+            const int32 RectW = Rect.Width() + 1;
+            Normals.SetNumUninitialized(RectW * (Rect.Height() + 1), EAllowShrinking::No);
+            for (int32 y = Rect.Min.Y; y <= Rect.Max.Y; ++y)
+            {
+                for (int32 x = Rect.Min.X; x <= Rect.Max.X; ++x)
+                {
+                    Normals[(y - Rect.Min.Y) * RectW + (x - Rect.Min.X)] = GridNormalAt(HeightCache, x, y);
+                }
+            }
         }
+        FootprintTables.UpdateRect(HeightCache, Rect, FootprintTables.HasSlope() ? &Normals : nullptr);
+        return;
     }
-    bCacheValid = true;
 
+    if (bDeformSnapshotDirty)
+    {
+        PublishDeformedSnapshot();
+    }
+}
 
-    // --- Optional softening pass (one-iteration Laplacian-like) ---
-    //if (bSmoothHeights)
-    //{
-    //    TArray<float> H; H.SetNumUninitialized(TotalVerts);
-    //    for (int32 i = 0; i < TotalVerts; ++i) H[i] = OutVertices[i].Z;
+void ANoiseTerrainActor::RefreshDeformedTile(int32 TileIndex)
+{
+    const FIntRect Rect = DeformDirtyRects[TileIndex];
+    DeformDirtyRects[TileIndex] = EmptyDirtyRect;
+    if (Rect.Max.X < Rect.Min.X) return;
 
-    //    for (int32 y = 1; y < VertsY - 1; ++y)
-    //    {
-    //        for (int32 x = 1; x < VertsX - 1; ++x)
-    //        {
-    //            const int32 i = y * VertsX + x;
-    //            const int32 l = i - 1, r = i + 1, u = i - VertsX, d = i + VertsX;
-    //            OutVertices[i].Z = (H[i] + H[l] + H[r] + H[u] + H[d]) / 5.f;
-    //        }
-    //    }
-    //}
+    FTerrainMeshData& Data = TerrainMesh->GetMutableMeshData();
+    const int32 VertsX = NumQuadsX + 1;
+    const int32 RectW = Rect.Width() + 1;
 
-    // --- Triangles (CCW, facing +Z) ---
-    OutTriangles.Reset();
-    OutTriangles.Reserve(NumQuadsX * NumQuadsY * 6);
-    auto V = [VertsX](int32 X, int32 Y) { return Y * VertsX + X; };
+    TArray<FVector>& Normals = Scratch.Normals;
+    Normals.SetNumUninitialized(RectW * (Rect.Height() + 1), EAllowShrinking::No);
 
-    for (int32 y = 0; y < NumQuadsY; ++y)
+    for (int32 y = Rect.Min.Y; y <= Rect.Max.Y; ++y)
     {
-        for (int32 x = 0; x < NumQuadsX; ++x)
+        for (int32 x = Rect.Min.X; x <= Rect.Max.X; ++x)
         {
-            const int32 v00 = V(x, y);
-            const int32 v10 = V(x + 1, y);
-            const int32 v01 = V(x, y + 1);
-            const int32 v11 = V(x + 1, y + 1);
-
-            // Front faces up (+Z)
-            OutTriangles.Add(v00); OutTriangles.Add(v11); OutTriangles.Add(v10);
-            OutTriangles.Add(v00); OutTriangles.Add(v01); OutTriangles.Add(v11);
+            const int32 i = CacheIndex(x, y, VertsX);
+            const FVector N = GridNormalAt(HeightCache, x, y);
+            Normals[(y - Rect.Min.Y) * RectW + (x - Rect.Min.X)] = N;
+            Data.Heights[i] = HeightCache[i];
+            Data.Normals[i] = FPackedNormal(FVector3f(N));
         }
     }
 
-    // --- Fast, smooth area-weighted normals ---
-    OutNormals.SetNumZeroed(TotalVerts);
-    for (int32 t = 0; t < OutTriangles.Num(); t += 3)
+    if (Data.Colors.Num() == Data.Heights.Num())
     {
-        const int32 ia = OutTriangles[t];
-        const int32 ib = OutTriangles[t + 1];
-        const int32 ic = OutTriangles[t + 2];
+        TArray<FColor>& Colors = Scratch.Colors;
+        Colors.SetNumUninitialized(Normals.Num(), EAllowShrinking::No);
+        BakeBlendWeights(HeightCache, WaterMap, Rect, Normals.GetData(), Colors.GetData());
 
-        const FVector& A = OutVertices[ia];
-        const FVector& B = OutVertices[ib];
-        const FVector& C = OutVertices[ic];
-
-        const FVector FaceN = FVector::CrossProduct(C - A, B - A); // area-weighted
-        OutNormals[ia] += FaceN;
-        OutNormals[ib] += FaceN;
-        OutNormals[ic] += FaceN;
+        for (int32 y = Rect.Min.Y; y <= Rect.Max.Y; ++y)
+        {
+            FMemory::Memcpy(&Data.Colors[CacheIndex(Rect.Min.X, y, VertsX)], &Colors[(y - Rect.Min.Y) * RectW], RectW * sizeof(FColor));
+        }
     }
-    
-    /*for (FVector& N : OutNormals) { N.Normalize(); }*/
-    for (FVector& N : OutNormals)
+
+    TerrainMesh->CommitTile(TileIndex);
+}
+
+void ANoiseTerrainActor::UpdateProcMeshFromCache(const FIntRect& Rect)
+{
+    FProcMeshSection* Section = ProcMesh ? ProcMesh->GetProcMeshSection(0) : nullptr;
+    const int32 VertsX = NumQuadsX + 1;
+    if (!Section || Section->ProcVertexBuffer.Num() != VertsX * (NumQuadsY + 1) || Rect.Max.X < Rect.Min.X) return;
+
+    const int32 RectW = Rect.Width() + 1;
+    const int32 RectVerts = RectW * (Rect.Height() + 1);
+
+    // Normals and colors only for the render section; the collision-only one keeps none
+    const bool bRenderSection = !bUseCompactTerrainMesh;
+    TArray<FVector>& Normals = Scratch.Normals;
+    TArray<FColor>& Colors = Scratch.Colors;
+    if (bRenderSection)
     {
-        const double Len2 = N.SizeSquared();
-        if (Len2 < 1e-12)
+        Normals.SetNumUninitialized(RectVerts, EAllowShrinking::No);
+        for (int32 y = Rect.Min.Y; y <= Rect.Max.Y; ++y)
         {
-            N = FVector::UpVector; // fallback to +Z normal if degenerate
+            for (int32 x = Rect.Min.X; x <= Rect.Max.X; ++x)
+            {
+                Normals[(y - Rect.Min.Y) * RectW + (x - Rect.Min.X)] = GridNormalAt(HeightCache, x, y);
+            }
         }
-        else
+        if (bBakeBlendWeights)
         {
-            N /= FMath::Sqrt(Len2); // normalize safely
+            Colors.SetNumUninitialized(RectVerts, EAllowShrinking::No);
+            BakeBlendWeights(HeightCache, WaterMap, Rect, Normals.GetData(), Colors.GetData());
         }
     }
 
+    // Patch the edited vertices in the section's own buffer
+    bool bLeavesBounds = false;
+    for (int32 y = Rect.Min.Y; y <= Rect.Max.Y; ++y)
+    {
+        for (int32 x = Rect.Min.X; x <= Rect.Max.X; ++x)
+        {
+            const int32 i = CacheIndex(x, y, VertsX);
+            const int32 r = (y - Rect.Min.Y) * RectW + (x - Rect.Min.X);
+
+            FProcMeshVertex& V = Section->ProcVertexBuffer[i];
+            V.Position.Z = HeightCache[i];
+            bLeavesBounds |= V.Position.Z < Section->SectionLocalBox.Min.Z || V.Position.Z > Section->SectionLocalBox.Max.Z;
+            if (bRenderSection)
+            {
+                V.Normal = Normals[r];
+                if (bBakeBlendWeights) V.Color = Colors[r];
+            }
+        }
+    }
 
-    // --- Simple tangents (+X). Good for most world-aligned materials. ---
-    OutTangents.SetNumUninitialized(TotalVerts);
-    for (int32 i = 0; i < TotalVerts; ++i)
+    // ProcMesh has no ranged upload: with no arrays it re-sends the (patched) buffer as is. Only
+    // positions outside the old bounds need the whole position array, which also refits the bounds.
+    TArray<FVector>& Positions = Scratch.Vertices;
+    Positions.Reset();
+    if (bLeavesBounds)
     {
-        OutTangents[i] = FProcMeshTangent(1.f, 0.f, 0.f);
+        Positions.SetNumUninitialized(Section->ProcVertexBuffer.Num(), EAllowShrinking::No);
+        for (int32 i = 0; i < Positions.Num(); ++i)
+        {
+            Positions[i] = Section->ProcVertexBuffer[i].Position;
+        }
     }
+    ProcMesh->UpdateMeshSection(0, Positions, TArray<FVector>(), TArray<FVector2D>(), TArray<FColor>(), TArray<FProcMeshTangent>());
 }
 
-
-void ANoiseTerrainActor::DebugDrawNormals(const TArray<FVector>& Vertices,
-    const TArray<FVector>& Normals)
+void ANoiseTerrainActor::ResetDeformation()
 {
- 
-    UWorld* World = GetWorld();
-    if (!World) return;
+    DeformDirtyRects.Reset();
+    DeformTileQueue.Reset();
+    DeformTileCursor = 0;
+    bDeformProcMeshDirty = false;
+    bDeformFootprintDirty = false;
+    bDeformSnapshotDirty = false;
+    DeformFootprintRect = EmptyDirtyRect;
+    DeformProcMeshRect = EmptyDirtyRect;
+
+    // Dropping the edits moves the surface too
+    if (bHeightsDeformed) ++HeightEditRevision;
+    bHeightsDeformed = false;
+}
 
-    // Clear previous persistent lines so you see the latest
-    FlushPersistentDebugLines(World);
+void ANoiseTerrainActor::BeginTiledDeformCollision(const FIntRect& EditRect)
+{
+    bDeformCollisionTiled = true;
 
-    if (!bDebugDrawNormals) return;
+    // Cooked asynchronously, the edit first, then nearest the pad/player, pumped from Tick like CoarseTiles
+    BuildCollisionTiles(&EditRect);
+    if (NumCollisionTilesReady == CollisionTileReady.Num())
+    {
+        DropFullMeshCollision();
+    }
+}
 
-    const FTransform T = GetActorTransform();
+bool ANoiseTerrainActor::HasFullMeshCollision() const
+{
+    const FProcMeshSection* Section = ProcMesh ? ProcMesh->GetProcMeshSection(0) : nullptr;
+    return Section && Section->bEnableCollision;
+}
 
-    // Draw up to ~512 samples for clarity
-    const int32 Step = FMath::Max(1, Vertices.Num() / 512);
+void ANoiseTerrainActor::DropFullMeshCollision()
+{
+    if (!HasFullMeshCollision()) return;
 
-    for (int32 i = 0; i < Vertices.Num(); i += Step)
+    if (bUseCompactTerrainMesh)
     {
-        const FVector P = T.TransformPosition(Vertices[i]);
-        const FVector N = T.TransformVectorNoScale(Normals[i]).GetSafeNormal();
-
-        // Persistent=true, LifeTime=30s so you can see them
-        DrawDebugLine(World, P, P + N * DebugNormalLength,
-            FColor::Cyan, /*bPersistentLines=*/true,
-            /*LifeTime=*/30.f, /*DepthPriority=*/0, /*Thickness=*/2.f);
+        // Section 0 only existed for its collision
+        ProcMesh->ClearMeshSection(0);
+    }
+    else
+    {
+        FProcMeshSection Section = *ProcMesh->GetProcMeshSection(0);
+        Section.bEnableCollision = false;
+        ProcMesh->SetProcMeshSection(0, Section);
     }
 }
 
+
 void ANoiseTerrainActor::BuildSlabSection()
 {
     // Compute slab extents from your flatten params
@@ -240,25 +1812,36 @@ void ANoiseTerrainActor::BuildSlabSection()
 
     const float zTop = FlattenHeight + SlabZOffset;
 
-    // 4 verts (CCW, +Z up)
-    TArray<FVector> V;
-    V.Reserve(4);
+    // 4 verts (CCW, +Z up), built in the scratch arrays
+    TArray<FVector>& V = Scratch.Vertices;
+    V.Reset();
     V.Add(FVector(FlattenCenter.X - hx, FlattenCenter.Y - hy, zTop)); // BL
     V.Add(FVector(FlattenCenter.X + hx, FlattenCenter.Y - hy, zTop)); // BR
     V.Add(FVector(FlattenCenter.X + hx, FlattenCenter.Y + hy, zTop)); // TR
     V.Add(FVector(FlattenCenter.X - hx, FlattenCenter.Y + hy, zTop)); // TL
 
-    TArray<int32> I = { 0, 2, 1, 0, 3, 2 };
+    TArray<int32>& I = Scratch.Indices;
+    I.Reset();
+    I.Append({ 0, 2, 1, 0, 3, 2 });
 
-    // Normals up, simple UVs 0..1
-    TArray<FVector> N; N.Init(FVector::UpVector, 4);
-    TArray<FVector2D> UV; UV.Reserve(4);
+    // Simple UVs 0..1
+    TArray<FVector2D>& UV = Scratch.UVs;
+    UV.Reset();
     UV.Add(FVector2D(0.f, 0.f));
     UV.Add(FVector2D(1.f, 0.f));
     UV.Add(FVector2D(1.f, 1.f));
     UV.Add(FVector2D(0.f, 1.f));
 
-    TArray<FProcMeshTangent> T; T.Init(FProcMeshTangent(1, 0, 0), 4);
+    // Normals up
+    TArray<FVector>& N = Scratch.Normals;
+    TArray<FProcMeshTangent>& T = Scratch.Tangents;
+    N.SetNumUninitialized(4, EAllowShrinking::No);
+    T.SetNumUninitialized(4, EAllowShrinking::No);
+    for (int32 k = 0; k < 4; ++k)
+    {
+        N[k] = FVector::UpVector;
+        T[k] = FProcMeshTangent(1, 0, 0);
+    }
 
     // Section 1, NO collision
     ProcMesh->CreateMeshSection_LinearColor(
@@ -270,6 +1853,12 @@ void ANoiseTerrainActor::BuildSlabSection()
 
 void ANoiseTerrainActor::BuildWaterSection()
 {
+    if (bTrimWaterToBodies && WaterMap.IsValid())
+    {
+        BuildTrimmedWaterSection();
+        return;
+    }
+
     // Terrain half extents in local space
     const float HalfW = NumQuadsX * GridSpacing * 0.5f + WaterPadding;
     const float HalfH = NumQuadsY * GridSpacing * 0.5f + WaterPadding;
@@ -277,28 +1866,37 @@ void ANoiseTerrainActor::BuildWaterSection()
     const float Z = WaterZ + WaterZOffset;
 
     // Quad corners (CCW, +Z up), centered like your terrain
-    TArray<FVector> V;
-    V.Reserve(4);
+    TArray<FVector>& V = Scratch.Vertices;
+    V.Reset();
     V.Add(FVector(-HalfW, -HalfH, Z)); // BL
     V.Add(FVector(+HalfW, -HalfH, Z)); // BR
     V.Add(FVector(+HalfW, +HalfH, Z)); // TR
     V.Add(FVector(-HalfW, +HalfH, Z)); // TL
 
-    TArray<int32> I = { 0, 2, 1, 0, 3, 2 };
-
-    // Up normals
-    TArray<FVector> N; N.Init(FVector::UpVector, 4);
+    TArray<int32>& I = Scratch.Indices;
+    I.Reset();
+    I.Append({ 0, 2, 1, 0, 3, 2 });
 
     // UVs with tiling (0..WaterUVTile)
     const float UMax = WaterUVTile;
     const float VMax = WaterUVTile;
-    TArray<FVector2D> UV; UV.Reserve(4);
+    TArray<FVector2D>& UV = Scratch.UVs;
+    UV.Reset();
     UV.Add(FVector2D(0.f, 0.f));
     UV.Add(FVector2D(UMax, 0.f));
     UV.Add(FVector2D(UMax, VMax));
     UV.Add(FVector2D(0.f, VMax));
 
-    TArray<FProcMeshTangent> T; T.Init(FProcMeshTangent(1, 0, 0), 4);
+    // Up normals
+    TArray<FVector>& N = Scratch.Normals;
+    TArray<FProcMeshTangent>& T = Scratch.Tangents;
+    N.SetNumUninitialized(4, EAllowShrinking::No);
+    T.SetNumUninitialized(4, EAllowShrinking::No);
+    for (int32 k = 0; k < 4; ++k)
+    {
+        N[k] = FVector::UpVector;
+        T[k] = FProcMeshTangent(1, 0, 0);
+    }
 
     // Section 2, NO collision
     ProcMesh->CreateMeshSection_LinearColor(
@@ -310,32 +1908,165 @@ void ANoiseTerrainActor::BuildWaterSection()
     ProcMesh->bCastDynamicShadow = false;
 }
 
+void ANoiseTerrainActor::BuildTrimmedWaterSection()
+{
+    const int32 VertsX = NumQuadsX + 1;
+
+    const float HalfW = NumQuadsX * GridSpacing * 0.5f;
+    const float HalfH = NumQuadsY * GridSpacing * 0.5f;
+    const float PadW = HalfW + WaterPadding;
+    const float PadH = HalfH + WaterPadding;
+
+    const float Z = WaterZ + WaterZOffset;
+
+    // A cell gets water when any corner is wet, grown by one cell so the surface tucks under the shore
+    TArray<uint8>& Wet = Scratch.WetCells;
+    Wet.SetNumUninitialized(NumQuadsX * NumQuadsY, EAllowShrinking::No);
+    FMemory::Memzero(Wet.GetData(), Wet.Num());
+    for (int32 cy = 0; cy < NumQuadsY; ++cy)
+    {
+        for (int32 cx = 0; cx < NumQuadsX; ++cx)
+        {
+            const bool bAnyWet =
+                WaterMap.GetBodyAt(cx, cy) != INDEX_NONE || WaterMap.GetBodyAt(cx + 1, cy) != INDEX_NONE ||
+                WaterMap.GetBodyAt(cx, cy + 1) != INDEX_NONE || WaterMap.GetBodyAt(cx + 1, cy + 1) != INDEX_NONE;
+            if (!bAnyWet) continue;
+
+            for (int32 ny = FMath::Max(cy - 1, 0); ny <= FMath::Min(cy + 1, NumQuadsY - 1); ++ny)
+            {
+                for (int32 nx = FMath::Max(cx - 1, 0); nx <= FMath::Min(cx + 1, NumQuadsX - 1); ++nx)
+                {
+                    Wet[ny * NumQuadsX + nx] = 1;
+                }
+            }
+        }
+    }
+
+    // Greedy rectangles: horizontal runs per row, extended downward while the next row repeats the run
+    // Cells [Min.X, Max.X) x [Min.Y, Max.Y)
+    TArray<FIntRect>& Done = Scratch.WaterRects;
+    TArray<FIntRect>& Open = Scratch.OpenRects;
+    TArray<FIntRect>& NextOpen = Scratch.NextOpenRects;
+    Done.Reset();
+    Open.Reset();
+
+    for (int32 cy = 0; cy < NumQuadsY; ++cy)
+    {
+        NextOpen.Reset();
+        int32 o = 0;
+        for (int32 cx = 0; cx < NumQuadsX; )
+        {
+            if (!Wet[cy * NumQuadsX + cx]) { ++cx; continue; }
+
+            const int32 X0 = cx;
+            while (cx < NumQuadsX && Wet[cy * NumQuadsX + cx]) ++cx;
+            const int32 X1 = cx;
+
+            // Open rects are sorted by X0 and disjoint, same as the runs of this row
+            while (o < Open.Num() && Open[o].Min.X < X0) Done.Add(Open[o++]);
+            if (o < Open.Num() && Open[o].Min.X == X0 && Open[o].Max.X == X1)
+            {
+                FIntRect Grown = Open[o++];
+                Grown.Max.Y = cy + 1;
+                NextOpen.Add(Grown);
+            }
+            else
+            {
+                NextOpen.Add(FIntRect(X0, cy, X1, cy + 1));
+            }
+        }
+        while (o < Open.Num()) Done.Add(Open[o++]);
+        Swap(Open, NextOpen);
+    }
+    Done.Append(Open);
+
+    if (Done.Num() == 0) return;
+
+    TArray<FVector>& V = Scratch.Vertices;
+    TArray<int32>& I = Scratch.Indices;
+    TArray<FVector2D>& UV = Scratch.UVs;
+    V.Reset();
+    I.Reset();
+    UV.Reset();
+    V.Reserve(Done.Num() * 4);
+    I.Reserve(Done.Num() * 6);
+    UV.Reserve(Done.Num() * 4);
+
+    // Rects touching the terrain edge keep the padding that hides the border
+    auto EdgeX = [&](int32 cx) { return cx == 0 ? -PadW : (cx == NumQuadsX ? PadW : cx * GridSpacing - HalfW); };
+    auto EdgeY = [&](int32 cy) { return cy == 0 ? -PadH : (cy == NumQuadsY ? PadH : cy * GridSpacing - HalfH); };
+
+    for (const FIntRect& R : Done)
+    {
+        const int32 Base = V.Num();
+        const float x0 = EdgeX(R.Min.X), x1 = EdgeX(R.Max.X);
+        const float y0 = EdgeY(R.Min.Y), y1 = EdgeY(R.Max.Y);
+
+        V.Add(FVector(x0, y0, Z)); // BL
+        V.Add(FVector(x1, y0, Z)); // BR
+        V.Add(FVector(x1, y1, Z)); // TR
+        V.Add(FVector(x0, y1, Z)); // TL
+
+        // Same tiling as the full-map quad, so trimming does not shift the ripples
+        for (int32 k = Base; k < Base + 4; ++k)
+        {
+            UV.Add(FVector2D((V[k].X + PadW) / (2.f * PadW) * WaterUVTile, (V[k].Y + PadH) / (2.f * PadH) * WaterUVTile));
+        }
+
+        I.Add(Base); I.Add(Base + 2); I.Add(Base + 1);
+        I.Add(Base); I.Add(Base + 3); I.Add(Base + 2);
+    }
+
+    TArray<FVector>& N = Scratch.Normals;
+    TArray<FProcMeshTangent>& T = Scratch.Tangents;
+    N.SetNumUninitialized(V.Num(), EAllowShrinking::No);
+    T.SetNumUninitialized(V.Num(), EAllowShrinking::No);
+    for (int32 k = 0; k < V.Num(); ++k)
+    {
+        N[k] = FVector::UpVector;
+        T[k] = FProcMeshTangent(1, 0, 0);
+    }
+
+    // Section 2, NO collision
+    ProcMesh->CreateMeshSection_LinearColor(
+        2, V, I, N, UV, TArray<FLinearColor>(), T, /*bCreateCollision=*/false);
+
+    if (WaterMaterial) { ProcMesh->SetMaterial(2, WaterMaterial); }
+    ProcMesh->bCastDynamicShadow = false;
+}
+
 float ANoiseTerrainActor::SampleHeightAtIndex(int32 ix, int32 iy, float LocalX, float LocalY) const
 {
     // Noise in *index* space  matches GenerateGrid
-    const float nx = (ix + NoiseOffset.X) * FeatureScale;
-    const float ny = (iy + NoiseOffset.Y) * FeatureScale;
+    // (shifted to the world grid in World noise space, so neighbours sample the same lattice)
+    const float nx = (NoiseGridOrigin.X + ix + NoiseOffset.X) * FeatureScale;
+    const float ny = (NoiseGridOrigin.Y + iy + NoiseOffset.Y) * FeatureScale;
     const float hNoise = NoisePtr ? NoisePtr->FBm2D(nx, ny, Octaves, Lacunarity, Persistence) : 0.f; // ~[-1,1]
     float Height = hNoise * HeightAmplitude;
 
     if (bEnableFlatten)
     {
-        const float Cx = FlattenCenter.X;
-        const float Cy = FlattenCenter.Y;
-        const float hx = 0.5f * FlattenSize.X;
-        const float hy = 0.5f * FlattenSize.Y;
+        Height = FMath::Lerp(Height, FlattenHeight, FlattenWeightAtLocalXY(LocalX, LocalY));
+    }
+    return Height;
+}
 
-        const float sx = FMath::Abs(LocalX - Cx) - hx;
-        const float sy = FMath::Abs(LocalY - Cy) - hy;
-        const float s = FMath::Max(sx, sy); // <= 0 inside rectangle
+float ANoiseTerrainActor::FlattenWeightAtLocalXY(float LocalX, float LocalY) const
+{
+    if (!bEnableFlatten) return 0.f;
 
-        const float falloff = FMath::Max(FlattenFalloff, 1.f); // avoid div by 0
-        const float t = FMath::Clamp(s / falloff, 0.f, 1.f);
-        const float w = 1.f - Smoothstep01(t); // 1 inside, 0 outside
+    const float Cx = FlattenCenter.X;
+    const float Cy = FlattenCenter.Y;
+    const float hx = 0.5f * FlattenSize.X;
+    const float hy = 0.5f * FlattenSize.Y;
 
-        Height = FMath::Lerp(Height, FlattenHeight, w);
-    }
-    return Height;
+    const float sx = FMath::Abs(LocalX - Cx) - hx;
+    const float sy = FMath::Abs(LocalY - Cy) - hy;
+    const float s = FMath::Max(sx, sy); // <= 0 inside rectangle
+
+    const float falloff = FMath::Max(FlattenFalloff, 1.f); // avoid div by 0
+    const float t = FMath::Clamp(s / falloff, 0.f, 1.f);
+    return 1.f - Smoothstep01(t); // 1 inside, 0 outside
 }
 
 float ANoiseTerrainActor::HeightAtLocalXY(float LocalX, float LocalY, bool bClampToBounds) const
@@ -404,6 +2135,190 @@ float ANoiseTerrainActor::GetHeightAtWorldXY(float WorldX, float WorldY, bool bC
 }
 
 
+void ANoiseTerrainActor::WorldToGrid(float WorldX, float WorldY, float& OutU, float& OutV) const
+{
+    const FVector L = GetActorTransform().InverseTransformPosition(FVector(WorldX, WorldY, 0.f));
+
+    const float HalfW = NumQuadsX * GridSpacing * 0.5f;
+    const float HalfH = NumQuadsY * GridSpacing * 0.5f;
+
+    OutU = FMath::Clamp((float)(L.X + HalfW) / GridSpacing, 0.f, (float)NumQuadsX);
+    OutV = FMath::Clamp((float)(L.Y + HalfH) / GridSpacing, 0.f, (float)NumQuadsY);
+}
+
+void ANoiseTerrainActor::FootprintToGridRect(const FVector& WorldCenter, const FVector2D& HalfExtent,
+    int32& OutX0, int32& OutY0, int32& OutX1, int32& OutY1) const
+{
+    const FVector L = GetActorTransform().InverseTransformPosition(WorldCenter);
+
+    const float U = (float)(L.X + NumQuadsX * GridSpacing * 0.5f) / GridSpacing;
+    const float V = (float)(L.Y + NumQuadsY * GridSpacing * 0.5f) / GridSpacing;
+    const float ExtU = FMath::Abs((float)HalfExtent.X) / GridSpacing;
+    const float ExtV = FMath::Abs((float)HalfExtent.Y) / GridSpacing;
+
+    OutX0 = FMath::CeilToInt(U - ExtU);
+    OutX1 = FMath::FloorToInt(U + ExtU);
+    OutY0 = FMath::CeilToInt(V - ExtV);
+    OutY1 = FMath::FloorToInt(V + ExtV);
+
+    // Footprint smaller than a cell: use the nearest vertex
+    if (OutX0 > OutX1) { OutX0 = OutX1 = FMath::RoundToInt(U); }
+    if (OutY0 > OutY1) { OutY0 = OutY1 = FMath::RoundToInt(V); }
+}
+
+FTerrainFootprintStats ANoiseTerrainActor::GetFootprintStats(FVector WorldCenter, FVector2D HalfExtent) const
+{
+    int32 X0, Y0, X1, Y1;
+    FootprintToGridRect(WorldCenter, HalfExtent, X0, Y0, X1, Y1);
+    return FootprintTables.Query(X0, Y0, X1, Y1);
+}
+
+void ANoiseTerrainActor::GetFootprintStatsBatch(const TArray<FVector>& WorldCenters, FVector2D HalfExtent,
+    TArray<FTerrainFootprintStats>& OutStats) const
+{
+    OutStats.SetNum(WorldCenters.Num());
+    for (int32 i = 0; i < WorldCenters.Num(); ++i)
+    {
+        int32 X0, Y0, X1, Y1;
+        FootprintToGridRect(WorldCenters[i], HalfExtent, X0, Y0, X1, Y1);
+        OutStats[i] = FootprintTables.Query(X0, Y0, X1, Y1);
+    }
+}
+
+bool ANoiseTerrainActor::ComputeViewshed(const FVector& WorldObserver, float ObserverHeight, float Radius,
+    FTerrainViewshed& OutViewshed, float TargetHeight) const
+{
+    const int32 VertsX = NumQuadsX + 1;
+    const int32 VertsY = NumQuadsY + 1;
+    if (!bCacheValid || HeightCache.Num() != VertsX * VertsY)
+    {
+        OutViewshed.Reset();
+        return false;
+    }
+
+    const FVector L = GetActorTransform().InverseTransformPosition(WorldObserver);
+    const int32 OX = FMath::RoundToInt((float)(L.X + NumQuadsX * GridSpacing * 0.5f) / GridSpacing);
+    const int32 OY = FMath::RoundToInt((float)(L.Y + NumQuadsY * GridSpacing * 0.5f) / GridSpacing);
+    if (OX < 0 || OY < 0 || OX >= VertsX || OY >= VertsY)
+    {
+        OutViewshed.Reset();
+        return false;
+    }
+
+    const float EyeZ = HeightCache[CacheIndex(OX, OY, VertsX)] + ObserverHeight;
+    OutViewshed.Compute(HeightCache, VertsX, VertsY, OX, OY, EyeZ, TargetHeight, Radius / GridSpacing);
+    return OutViewshed.IsValid();
+}
+
+bool ANoiseTerrainActor::IsVisibleInViewshed(const FTerrainViewshed& Viewshed, float WorldX, float WorldY) const
+{
+    float U, V;
+    WorldToGrid(WorldX, WorldY, U, V);
+    return Viewshed.IsVisible(FMath::RoundToInt(U), FMath::RoundToInt(V));
+}
+
+float ANoiseTerrainActor::GetViewshedCoverage(FVector WorldObserver, float ObserverHeight, float Radius, float TargetHeight) const
+{
+    FTerrainViewshed Viewshed;
+    if (!ComputeViewshed(WorldObserver, ObserverHeight, Radius, Viewshed, TargetHeight)) return 0.f;
+    return (float)Viewshed.GetNumVisible() / (float)FMath::Max(Viewshed.GetNumCells(), 1);
+}
+
+bool ANoiseTerrainActor::GetRandomSpawnLocation(int32 Zone, FRandomStream& Stream, FVector& OutLocation) const
+{
+    FVector2f Local;
+    if (!SpawnZones.Draw(Zone, Stream, Local)) return false;
+
+    OutLocation = GetActorTransform().TransformPosition(FVector(Local.X, Local.Y, HeightAtLocalXY(Local.X, Local.Y)));
+    return true;
+}
+
+float ANoiseTerrainActor::GetShoreDistanceAtWorldXY(float WorldX, float WorldY) const
+{
+    float U, V;
+    WorldToGrid(WorldX, WorldY, U, V);
+    return WaterMap.SampleShoreDistance(U, V);
+}
+
+int32 ANoiseTerrainActor::GetWaterBodyAtWorldXY(float WorldX, float WorldY) const
+{
+    if (!WaterMap.IsValid()) return INDEX_NONE;
+
+    float U, V;
+    WorldToGrid(WorldX, WorldY, U, V);
+    return WaterMap.GetBodyAt(FMath::RoundToInt(U), FMath::RoundToInt(V));
+}
+
+
+bool ANoiseTerrainActor::RaycastTerrain(const FVector& WorldStart, const FVector& WorldEnd,
+    FVector& OutHitLocation, FVector& OutHitNormal) const
+{
+    if (GridSpacing <= 0.f) return false;
+
+    const FTransform& T = GetActorTransform();
+    const FVector A = T.InverseTransformPosition(WorldStart);
+    const FVector D = T.InverseTransformPosition(WorldEnd) - A;
+
+    auto Gap = [this, &A, &D](float t)
+    {
+        const FVector P = A + D * t;
+        return (float)P.Z - HeightAtLocalXY(P.X, P.Y, /*bClampToBounds=*/true);
+    };
+
+    // Only the part of the ray over the grid can hit; outside it there is no terrain, not the
+    // clamped border heights
+    float T0 = 0.f, T1 = 1.f;
+    auto ClipSlab = [&T0, &T1](double Origin, double Dir, float HalfExtent)
+    {
+        if (FMath::Abs(Dir) < KINDA_SMALL_NUMBER)
+        {
+            return Origin >= -HalfExtent && Origin <= HalfExtent;
+        }
+        float TA = (float)((-HalfExtent - Origin) / Dir);
+        float TB = (float)((HalfExtent - Origin) / Dir);
+        if (TA > TB) Swap(TA, TB);
+        T0 = FMath::Max(T0, TA);
+        T1 = FMath::Min(T1, TB);
+        return T0 <= T1;
+    };
+    if (!ClipSlab(A.X, D.X, NumQuadsX * GridSpacing * 0.5f) || !ClipSlab(A.Y, D.Y, NumQuadsY * GridSpacing * 0.5f))
+    {
+        return false;
+    }
+
+    // March in half-cell steps, then bisect the bracketing interval
+    const float ClippedLength = (float)FVector2D(D.X, D.Y).Size() * (T1 - T0);
+    const int32 Steps = FMath::Max(1, FMath::CeilToInt(ClippedLength / (GridSpacing * 0.5f)));
+
+    float PrevT = T0;
+    bool bHit = Gap(T0) <= 0.f;
+    float HitT = T0;
+
+    for (int32 s = 1; s <= Steps && !bHit; ++s)
+    {
+        const float t = FMath::Lerp(T0, T1, (float)s / (float)Steps);
+        if (Gap(t) <= 0.f)
+        {
+            float Lo = PrevT, Hi = t;
+            for (int32 k = 0; k < 10; ++k)
+            {
+                const float Mid = 0.5f * (Lo + Hi);
+                if (Gap(Mid) <= 0.f) Hi = Mid; else Lo = Mid;
+            }
+            HitT = Hi;
+            bHit = true;
+        }
+        PrevT = t;
+    }
+
+    if (!bHit) return false;
+
+    const FVector Local = A + D * HitT;
+    OutHitLocation = T.TransformPosition(FVector(Local.X, Local.Y, HeightAtLocalXY(Local.X, Local.Y, true)));
+    OutHitNormal = GetNormalAtWorldXY(OutHitLocation.X, OutHitLocation.Y, true);
+    return true;
+}
+
 FVector ANoiseTerrainActor::GetNormalAtWorldXY(float WorldX, float WorldY, bool bClampToBounds) const
 {
     if (GridSpacing <= 0.f) return FVector::UpVector;
@@ -424,7 +2339,8 @@ FVector ANoiseTerrainActor::GetNormalAtWorldXY(float WorldX, float WorldY, bool
     const FVector dX(2.f * GridSpacing, 0.f, hR - hL);
     const FVector dY(0.f, 2.f * GridSpacing, hF - hB);
 
-    FVector N = FVector::CrossProduct(dY, dX);
+    // X then Y, so the normal faces up (+Z)
+    FVector N = FVector::CrossProduct(dX, dY);
     const double len2 = N.SizeSquared();
     return (len2 < 1e-12) ? FVector::UpVector : N / FMath::Sqrt(len2);
 }
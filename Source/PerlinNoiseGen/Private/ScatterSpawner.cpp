@@ -1,8 +1,22 @@
 #include "ScatterSpawner.h"
 #include "NoiseTerrainActor.h"
+#include "TerrainHorizonOcclusion.h"
 #include "Components/SceneComponent.h"
 #include "Engine/World.h"
 #include "Kismet/KismetMathLibrary.h"
+#include "Async/ParallelFor.h"
+#include "Hash/CityHash.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+namespace
+{
+    // On-disk scatter cache header; bump the version whenever placement logic changes
+    constexpr uint32 ScatterCacheMagic = 0x31544353; // "SCT1"
+    constexpr int32 ScatterCacheVersion = 3;
+}
 
 AScatterSpawner::AScatterSpawner()
 {
@@ -16,48 +30,348 @@ void AScatterSpawner::OnConstruction(const FTransform& /*Xform*/)
 
 void AScatterSpawner::ClearSpawned()
 {
-    for (auto& W : SpawnedActors)
+    ReleaseAll();
+    CommitSpawns();
+    FlushPool();
+
+//#if WITH_EDITOR
+//        SpawnContainer->Modify();
+//#endif
+//        SpawnContainer->Destroy();
+//        SpawnContainer = nullptr;
+}
+
+void AScatterSpawner::ReleaseAll()
+{
+    // Tracked actors plus any leftover children under the container (defensive; also picks up
+    // actors from an earlier editor session, which the pool can then reuse)
+    TSet<AActor*> Actors;
+    for (FScatterRequestState& State : RequestStates)
     {
-        if (AActor* A = W.Get())
+        for (FScatterTile& Tile : State.Tiles)
         {
-#if WITH_EDITOR
-            A->Modify();
-#endif
-            A->Destroy();
+            for (const TWeakObjectPtr<AActor>& W : Tile.Actors)
+            {
+                if (AActor* A = W.Get()) Actors.Add(A);
+            }
         }
     }
-    SpawnedActors.Reset();
-
-    // also destroy any leftover children under the container (defensive)
     if (SpawnContainer)
     {
         TArray<AActor*> Attached;
         SpawnContainer->GetAttachedActors(Attached);
         for (AActor* Child : Attached)
         {
-#if WITH_EDITOR
-            if (Child) Child->Modify();
-#endif
-            if (Child) Child->Destroy();
+            if (Child) Actors.Add(Child);
         }
+    }
 
-//#if WITH_EDITOR
-//        SpawnContainer->Modify();
-//#endif
-//        SpawnContainer->Destroy();
-//        SpawnContainer = nullptr;
+    for (AActor* A : Actors)
+    {
+        ReleaseActor(A);
     }
+
+    RequestStates.Reset();
+    LayoutHash = 0;
+    ResetInstanceIndex();
 }
 
 void AScatterSpawner::Generate()
+{
+    if (!BeginStagedGenerate()) return;
+    ComputeStagedGenerate(Terrain->GetUpToDateSnapshot());
+    CommitStagedGenerate(DBL_MAX);
+}
+
+bool AScatterSpawner::BeginStagedGenerate()
 {
     if (!Terrain)
     {
         UE_LOG(LogTemp, Warning, TEXT("ScatterSpawner: Terrain is null."));
+        return false;
+    }
+
+    // Make sure we have a container; reuse if it already exists
+    if (!EnsureSpawnContainer())
+    {
+        UE_LOG(LogTemp, Warning, TEXT("ScatterSpawner: Failed to create/reuse SpawnContainer."));
+        return false;
+    }
+
+    UpdateLayout();
+    AssignRequestIds();
+    ResetRejections();
+
+    StagedCompute.Reset();
+    StagedSpawn.Reset();
+    StagedSpawnCursor = 0;
+
+    // Runtime edits aren't part of the key, so a deformed terrain never touches the disk cache
+    bStagedUseDiskCache = bCacheResults && !Terrain->HasDeformedHeights();
+
+    // Runtime edits move the surface without changing the layout hash; RegenerateRegion catches
+    // up the edited tiles, anything it didn't see means every request is placed again
+    const bool bSurfaceEdited = Terrain->GetHeightEditRevision() != SeenHeightEditRevision;
+    SeenHeightEditRevision = Terrain->GetHeightEditRevision();
+
+    // New seed/region/terrain, or nothing tracked yet (container children from an earlier
+    // session are untracked): every request starts over
+    const uint64 NewLayoutHash = GetLayoutHash();
+    if (NewLayoutHash != LayoutHash || RequestStates.Num() == 0)
+    {
+        ReleaseAll();
+        LayoutHash = NewLayoutHash;
+
+        // Recording rejections needs every tile placed for real
+        const uint64 CacheHash = (bStagedUseDiskCache && !bRecordRejections) ? GetScatterHash() : 0;
+        if (CacheHash != 0 && LoadScatterCache(CacheHash))
+        {
+            UE_LOG(LogTemp, Log, TEXT("ScatterSpawner: reusing cached placements %s"), *GetScatterCachePath(CacheHash));
+            for (int32 i = 0; i < RequestStates.Num(); ++i)
+            {
+                StagedSpawn.Add(i);
+            }
+            return true;
+        }
+    }
+
+    // Built state follows its request by Id, so removing or reordering requests keeps the rest
+    TMap<FGuid, int32> RequestById;
+    for (int32 i = 0; i < Requests.Num(); ++i)
+    {
+        RequestById.Add(Requests[i].Id, i);
+    }
+
+    bool bReordered = false;
+    for (int32 i = 0; i < RequestStates.Num(); ++i)
+    {
+        const int32* NewIndex = RequestById.Find(RequestStates[i].Id);
+        if (!NewIndex) ReleaseRequest(i);
+        else if (*NewIndex != i) bReordered = true;
+    }
+
+    if (bReordered || RequestStates.Num() != Requests.Num())
+    {
+        TArray<FScatterRequestState> Old = MoveTemp(RequestStates);
+        RequestStates.SetNum(Requests.Num());
+        for (FScatterRequestState& State : Old)
+        {
+            if (const int32* NewIndex = RequestById.Find(State.Id))
+            {
+                RequestStates[*NewIndex] = MoveTemp(State);
+            }
+        }
+
+        // Index refs name requests by position
+        if (bReordered)
+        {
+            ResetInstanceIndex();
+            for (int32 i = 0; i < RequestStates.Num(); ++i)
+            {
+                for (int32 t = 0; t < RequestStates[i].Tiles.Num(); ++t)
+                {
+                    const FScatterTile& Tile = RequestStates[i].Tiles[t];
+                    if (Tile.Removed.Num() == Tile.Placements.Num()) IndexTile(i, t);
+                }
+            }
+        }
+    }
+    for (int32 i = 0; i < Requests.Num(); ++i)
+    {
+        RequestStates[i].Id = Requests[i].Id;
+    }
+
+    // Only requests whose settings changed
+    for (int32 i = 0; i < Requests.Num(); ++i)
+    {
+        FScatterRequestState& State = RequestStates[i];
+        const uint64 Hash = HashRequest(Requests[i]);
+        if (!bSurfaceEdited && State.SettingsHash == Hash && State.Tiles.Num() == ScatterTilesX * ScatterTilesY)
+        {
+            continue;
+        }
+
+        ReleaseRequest(i);
+        State.SettingsHash = Hash;
+        State.Tiles.SetNum(ScatterTilesX * ScatterTilesY);
+        StagedCompute.Add(i);
+        StagedSpawn.Add(i);
+    }
+    return true;
+}
+
+void AScatterSpawner::ComputeStagedGenerate(FTerrainSnapshotPtr Ground)
+{
+    if (!Ground.IsValid() || !Ground->IsValid())
+    {
+        UE_LOG(LogTemp, Warning, TEXT("ScatterSpawner: Terrain has no heights to place on."));
+
+        // Left empty, and placed again by the next Generate
+        for (int32 i : StagedCompute)
+        {
+            RequestStates[i].SettingsHash = 0;
+        }
+        return;
+    }
+
+    // Every tile of every changed request in one ParallelFor; placement only reads the snapshot
+    const int32 NumTiles = ScatterTilesX * ScatterTilesY;
+    FScatterRejectionMap* Sink = GetRejectionSink();
+    const FTerrainSnapshot& Snapshot = *Ground;
+    ParallelFor(StagedCompute.Num() * NumTiles, [this, &Snapshot, NumTiles, Sink](int32 k)
+    {
+        const int32 RequestIndex = StagedCompute[k / NumTiles];
+        const int32 TileIndex = k % NumTiles;
+        ComputeTile(Snapshot, RequestIndex, TileIndex, RequestStates[RequestIndex].Tiles[TileIndex].Placements, Sink);
+    });
+}
+
+bool AScatterSpawner::CommitStagedGenerate(double DeadlineSeconds)
+{
+    const int32 NumTiles = ScatterTilesX * ScatterTilesY;
+    const int32 NumSpawnTiles = StagedSpawn.Num() * NumTiles;
+
+    while (StagedSpawnCursor < NumSpawnTiles)
+    {
+        SpawnTile(StagedSpawn[StagedSpawnCursor / NumTiles], StagedSpawnCursor % NumTiles);
+        ++StagedSpawnCursor;
+        if (FPlatformTime::Seconds() >= DeadlineSeconds) return false;
+    }
+
+    if (!CommitSpawns(DeadlineSeconds)) return false;
+    FlushPool();
+
+    for (int32 i : StagedCompute)
+    {
+        const FSpawnRequest& R = Requests[i];
+        if (!R.ActorClass) continue;
+
+        int32 Placed = 0;
+        for (const FScatterTile& Tile : RequestStates[i].Tiles) Placed += Tile.Placements.Num();
+        UE_LOG(LogTemp, Log, TEXT("ScatterSpawner: %d/%d placed for %s"), Placed, R.Count, *R.ActorClass->GetName());
+    }
+    UE_LOG(LogTemp, Log, TEXT("ScatterSpawner: regenerated %d/%d requests"), StagedCompute.Num(), Requests.Num());
+
+    if (StagedCompute.Num() > 0 && bStagedUseDiskCache)
+    {
+        SaveScatterCache(GetScatterHash());
+    }
+    PublishRejections();
+
+    StagedCompute.Reset();
+    StagedSpawn.Reset();
+    StagedSpawnCursor = 0;
+    return true;
+}
+
+float AScatterSpawner::GetStagedProgress() const
+{
+    // Half for placing tiles, half for finishing deferred spawns
+    const int32 NumSpawnTiles = StagedSpawn.Num() * ScatterTilesX * ScatterTilesY;
+    if (NumSpawnTiles == 0) return 1.f;
+
+    const float TileFraction = (float)StagedSpawnCursor / (float)NumSpawnTiles;
+    const float SpawnFraction = PendingSpawns.Num() > 0 ? (float)PendingSpawnCursor / (float)PendingSpawns.Num() : 0.f;
+    return 0.5f * TileFraction + (TileFraction >= 1.f ? 0.5f * SpawnFraction : 0.f);
+}
+
+void AScatterSpawner::RegenerateRequest(int32 RequestIndex)
+{
+    if (!Terrain || !Requests.IsValidIndex(RequestIndex)) return;
+
+    UpdateLayout();
+    if (GetLayoutHash() != LayoutHash || !AreRequestStatesCurrent())
+    {
+        Generate();
+        return;
+    }
+
+    const FTerrainSnapshotPtr Ground = GetGround();
+    if (!Ground.IsValid()) return;
+
+    ResetRejections();
+    RebuildRequest(*Ground, RequestIndex);
+    CommitSpawns();
+    FlushPool();
+    PublishRejections();
+}
+
+void AScatterSpawner::RegenerateRegion(FVector2D LocalMin, FVector2D LocalMax)
+{
+    if (!Terrain) return;
+
+    UpdateLayout();
+    if (GetLayoutHash() != LayoutHash || !AreRequestStatesCurrent())
+    {
+        Generate();
         return;
     }
 
+    const FTerrainSnapshotPtr Ground = GetGround();
+    if (!Ground.IsValid()) return;
+
+    const float TileSize = FMath::Max(ScatterTileSize, 1.f);
+    const int32 TX0 = FMath::Clamp(FMath::FloorToInt((FMath::Min(LocalMin.X, LocalMax.X) - ScatterMin.X) / TileSize), 0, ScatterTilesX - 1);
+    const int32 TX1 = FMath::Clamp(FMath::FloorToInt((FMath::Max(LocalMin.X, LocalMax.X) - ScatterMin.X) / TileSize), 0, ScatterTilesX - 1);
+    const int32 TY0 = FMath::Clamp(FMath::FloorToInt((FMath::Min(LocalMin.Y, LocalMax.Y) - ScatterMin.Y) / TileSize), 0, ScatterTilesY - 1);
+    const int32 TY1 = FMath::Clamp(FMath::FloorToInt((FMath::Max(LocalMin.Y, LocalMax.Y) - ScatterMin.Y) / TileSize), 0, ScatterTilesY - 1);
+
+    ResetRejections();
+    FScatterRejectionMap* Sink = GetRejectionSink();
+
+    TArray<int32> TileIndices;
+    for (int32 ty = TY0; ty <= TY1; ++ty)
+    {
+        for (int32 tx = TX0; tx <= TX1; ++tx)
+        {
+            TileIndices.Add(ty * ScatterTilesX + tx);
+        }
+    }
+
+    for (int32 i = 0; i < Requests.Num(); ++i)
+    {
+        FScatterRequestState& State = RequestStates[i];
+        if (!Requests[i].ActorClass || State.Tiles.Num() != ScatterTilesX * ScatterTilesY) continue;
+
+        for (int32 t : TileIndices)
+        {
+            ReleaseTile(i, t);
+        }
+        ParallelFor(TileIndices.Num(), [&](int32 k)
+        {
+            ComputeTile(*Ground, i, TileIndices[k], State.Tiles[TileIndices[k]].Placements, Sink);
+        });
+        for (int32 t : TileIndices)
+        {
+            SpawnTile(i, t);
+        }
+    }
+    CommitSpawns();
+    FlushPool();
+
+    // The edit this catches up on no longer forces a full Generate
+    SeenHeightEditRevision = Terrain->GetHeightEditRevision();
+
+    if (bCacheResults && !Terrain->HasDeformedHeights())
+    {
+        SaveScatterCache(GetScatterHash());
+    }
+    PublishRejections();
+}
+
+FTerrainSnapshotPtr AScatterSpawner::GetGround() const
+{
+    const FTerrainSnapshotPtr Ground = Terrain->GetUpToDateSnapshot();
+    if (!Ground.IsValid() || !Ground->IsValid())
+    {
+        UE_LOG(LogTemp, Warning, TEXT("ScatterSpawner: Terrain has no heights to place on."));
+        return nullptr;
+    }
+    return Ground;
+}
 
+void AScatterSpawner::UpdateLayout()
+{
     // Terrain extents in local space
     const float HalfW = Terrain->NumQuadsX * Terrain->GridSpacing * 0.5f;
     const float HalfH = Terrain->NumQuadsY * Terrain->GridSpacing * 0.5f;
@@ -75,153 +389,753 @@ void AScatterSpawner::Generate()
         if (LocMax.Y < LocMin.Y) Swap(LocMax.Y, LocMin.Y);
     }
 
-    FRandomStream RNG(Seed);
+    const float TileSize = FMath::Max(ScatterTileSize, 1.f);
+    ScatterMin = LocMin;
+    ScatterMax = LocMax;
+    ScatterTilesX = FMath::Max(FMath::CeilToInt((LocMax.X - LocMin.X) / TileSize), 1);
+    ScatterTilesY = FMath::Max(FMath::CeilToInt((LocMax.Y - LocMin.Y) / TileSize), 1);
+}
 
-    // Make sure we have a container; reuse if it already exists
-    if (!EnsureSpawnContainer())
+int32 AScatterSpawner::GetTileQuota(const FSpawnRequest& R, int32 TileIndex) const
+{
+    // Count split by area with cumulative rounding: tile quotas always sum to exactly Count
+    const double TileSize = FMath::Max(ScatterTileSize, 1.f);
+    const double W = ScatterMax.X - ScatterMin.X;
+    const double H = ScatterMax.Y - ScatterMin.Y;
+    const double Total = W * H;
+    if (Total <= 0.0) return TileIndex == 0 ? R.Count : 0;
+
+    const int32 tx = TileIndex % ScatterTilesX;
+    const int32 ty = TileIndex / ScatterTilesX;
+    const double RowH = FMath::Min(TileSize, H - ty * TileSize);
+    const double TileW = FMath::Min(TileSize, W - tx * TileSize);
+
+    const double AreaBefore = W * FMath::Min(ty * TileSize, H) + RowH * FMath::Min(tx * TileSize, W);
+    const double AreaAfter = AreaBefore + RowH * TileW;
+    return FMath::RoundToInt(R.Count * AreaAfter / Total) - FMath::RoundToInt(R.Count * AreaBefore / Total);
+}
+
+void AScatterSpawner::AssignRequestIds()
+{
+    // Derived from our path and the slot, so an unsaved spawner still scatters the same each run
+    TSet<FGuid> Used;
+    for (int32 i = 0; i < Requests.Num(); ++i)
     {
-        UE_LOG(LogTemp, Warning, TEXT("ScatterSpawner: Failed to create/reuse SpawnContainer."));
-        return;
+        FGuid& Id = Requests[i].Id;
+        uint64 Salt = (uint64)i;
+        while (!Id.IsValid() || Used.Contains(Id))
+        {
+            Id = FGuid::NewDeterministicGuid(GetPathName(), Salt);
+            Salt += Requests.Num();
+        }
+        Used.Add(Id);
     }
+}
 
-    for (const FSpawnRequest& R : Requests)
+bool AScatterSpawner::AreRequestStatesCurrent() const
+{
+    if (RequestStates.Num() != Requests.Num()) return false;
+    for (int32 i = 0; i < Requests.Num(); ++i)
     {
-        if (!R.ActorClass) continue;
+        if (RequestStates[i].Id != Requests[i].Id) return false;
+    }
+    return true;
+}
+
+void AScatterSpawner::ResetRejections()
+{
+    if (bRecordRejections)
+    {
+        Rejections.Init(FVector2f(ScatterMin), FVector2f(ScatterMax), RejectionCellSize);
+    }
+    else
+    {
+        Rejections.Reset();
+    }
+}
+
+void AScatterSpawner::PublishRejections()
+{
+    if (bRecordRejections && Terrain)
+    {
+        Terrain->SetScatterRejections(Rejections);
+    }
+}
+
+void AScatterSpawner::ComputeTile(const FTerrainSnapshot& Ground, int32 RequestIndex, int32 TileIndex, TArray<FTransform>& Out,
+    FScatterRejectionMap* OutRejections) const
+{
+    const FSpawnRequest& R = Requests[RequestIndex];
+    Out.Reset();
+    if (!R.ActorClass) return;
+
+    const int32 Quota = GetTileQuota(R, TileIndex);
+    if (Quota <= 0) return;
+    Out.Reserve(Quota);
+
+    const float TileSize = FMath::Max(ScatterTileSize, 1.f);
+    const int32 tx = TileIndex % ScatterTilesX;
+    const int32 ty = TileIndex / ScatterTilesX;
+    const FVector2D TileMin(ScatterMin.X + tx * TileSize, ScatterMin.Y + ty * TileSize);
+    const FVector2D TileMax(FMath::Min(TileMin.X + TileSize, ScatterMax.X), FMath::Min(TileMin.Y + TileSize, ScatterMax.Y));
+
+    // Spacing is only checked inside a tile, so keep half of it clear on either side of shared
+    // tile edges; neighbours then can't end up closer than MinSpacing either
+    const float Inset = R.MinSpacing > 0.f ? 0.5f * R.MinSpacing : 0.f;
+    const FVector2D PickMin(tx > 0 ? TileMin.X + Inset : TileMin.X, ty > 0 ? TileMin.Y + Inset : TileMin.Y);
+    const FVector2D PickMax(tx < ScatterTilesX - 1 ? TileMax.X - Inset : TileMax.X, ty < ScatterTilesY - 1 ? TileMax.Y - Inset : TileMax.Y);
+    if (PickMax.X <= PickMin.X || PickMax.Y <= PickMin.Y) return;
+
+    // Own stream per (seed, request Id, tile): a tile regenerates the same regardless of the others
+    // or of where the request sits in the list
+    FRandomStream RNG(HashCombine(HashCombine(GetTypeHash(Seed), GetTypeHash(R.Id)), GetTypeHash(TileIndex)));
+
+    TArray<FVector2D> Placed2D;
+    Placed2D.Reserve(Quota);
+
+    int32 Tries = 0;
+    const int32 MaxTries = FMath::Max(1, R.MaxTriesPerInstance) * Quota;
+
+    while (Out.Num() < Quota && Tries < MaxTries)
+    {
+        ++Tries;
+
+        // Random local XY in this tile
+        const float rx = RNG.FRandRange(PickMin.X, PickMax.X);
+        const float ry = RNG.FRandRange(PickMin.Y, PickMax.Y);
+
+        // Local -> World (XY)
+        const FVector WorldOnPlane = Ground.ActorTransform.TransformPosition(FVector(rx, ry, 0.f));
 
-        TArray<FVector2D> Placed2D;
-        Placed2D.Reserve(R.Count);
+        float z = 0.f;
+        FVector n = FVector::UpVector;
+        EScatterRejectReason Reason = EScatterRejectReason::Count;
 
-        int32 Spawned = 0;
-        int32 Tries = 0;
-        const int32 MaxTries = FMath::Max(1, R.MaxTriesPerInstance) * FMath::Max(1, R.Count);
+        if (!AcceptByConstraints(Ground, R, WorldOnPlane.X, WorldOnPlane.Y, z, n, Reason))
+        {
+            if (OutRejections) OutRejections->Add(rx, ry, Reason);
+            continue;
+        }
 
-        while (Spawned < R.Count && Tries < MaxTries)
+        if (R.MinSpacing > 0 && !RespectSpacing(R, WorldOnPlane.X, WorldOnPlane.Y, Placed2D))
         {
-            ++Tries;
+            if (OutRejections) OutRejections->Add(rx, ry, EScatterRejectReason::Spacing);
+            continue;
+        }
 
-            // Random local XY on terrain (or constrained region)
-            const float rx = RNG.FRandRange(LocMin.X, LocMax.X);
-            const float ry = RNG.FRandRange(LocMin.Y, LocMax.Y);
+        // Random spin around the surface normal
+        const float SpinDeg = R.bRandomYaw ? RNG.FRandRange(0.f, 360.f) : 0.f;
+        const float ScaleU = RNG.FRandRange(R.UniformScaleRange.X, R.UniformScaleRange.Y);
 
-            // Local -> World (XY)
-            const FVector WorldOnPlane = Terrain->GetActorTransform().TransformPosition(FVector(rx, ry, 0.f));
+        // Ensure the normal is normalized
+        const FVector N = n.GetSafeNormal();
 
-            float z = 0.f;
-            FVector n = FVector::UpVector;
+        // Lift along the normal to avoid clipping on slopes
+        const FVector Loc = FVector(WorldOnPlane.X, WorldOnPlane.Y, z) + N * R.SurfaceOffset;
 
-            if (!AcceptByConstraints(R, WorldOnPlane.X, WorldOnPlane.Y, z, n))
-                continue;
+        // Build rotation: align actor's +Z to the surface normal, then spin around that normal
+        const FQuat AlignQuat = FRotationMatrix::MakeFromZ(N).ToQuat();
+        const FQuat SpinQuat = FQuat(N, FMath::DegreesToRadians(SpinDeg));
+        const FQuat FinalQuat = SpinQuat * AlignQuat;
 
-            if (R.MinSpacing > 0 && !RespectSpacing(R, WorldOnPlane.X, WorldOnPlane.Y, Placed2D))
-                continue;
+        Out.Add(FTransform(FinalQuat, Loc, FVector(ScaleU)));
+        Placed2D.Add(FVector2D(WorldOnPlane.X, WorldOnPlane.Y));
+    }
+}
 
-            // Random spin around the surface normal
-            const float SpinDeg = R.bRandomYaw ? RNG.FRandRange(0.f, 360.f) : 0.f;
-            const float ScaleU = FMath::FRandRange(R.UniformScaleRange.X, R.UniformScaleRange.Y);
+void AScatterSpawner::RebuildRequest(const FTerrainSnapshot& Ground, int32 RequestIndex)
+{
+    const FSpawnRequest& R = Requests[RequestIndex];
+    FScatterRequestState& State = RequestStates[RequestIndex];
 
-            // Ensure the normal is normalized
-            const FVector N = n.GetSafeNormal();
+    ReleaseRequest(RequestIndex);
+    State.SettingsHash = HashRequest(R);
+    State.Tiles.SetNum(ScatterTilesX * ScatterTilesY);
+    if (!R.ActorClass) return;
 
-            // Lift along the normal to avoid clipping on slopes
-            const FVector Loc = FVector(WorldOnPlane.X, WorldOnPlane.Y, z) + N * R.SurfaceOffset;
+    // Tiles are independent and placement only reads the snapshot
+    FScatterRejectionMap* Sink = GetRejectionSink();
+    ParallelFor(State.Tiles.Num(), [&](int32 t)
+    {
+        ComputeTile(Ground, RequestIndex, t, State.Tiles[t].Placements, Sink);
+    });
 
-            // Build rotation: align actor's +Z to the surface normal, then spin around that normal
-            const FQuat AlignQuat = FRotationMatrix::MakeFromZ(N).ToQuat();
-            const FQuat SpinQuat = FQuat(N, FMath::DegreesToRadians(SpinDeg));
-            const FQuat FinalQuat = SpinQuat * AlignQuat;
+    int32 Placed = 0;
+    for (int32 t = 0; t < State.Tiles.Num(); ++t)
+    {
+        SpawnTile(RequestIndex, t);
+        Placed += State.Tiles[t].Placements.Num();
+    }
 
-            FTransform T;
-            T.SetLocation(Loc);
-            T.SetRotation(FinalQuat);
-            T.SetScale3D(FVector(ScaleU));
+    UE_LOG(LogTemp, Log, TEXT("ScatterSpawner: %d/%d placed for %s"), Placed, R.Count, *R.ActorClass->GetName());
+}
 
+void AScatterSpawner::SpawnTile(int32 RequestIndex, int32 TileIndex)
+{
+    const FSpawnRequest& R = Requests[RequestIndex];
+    FScatterTile& Tile = RequestStates[RequestIndex].Tiles[TileIndex];
 
-            FActorSpawnParameters P;
-            P.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn;
+    // Actors and Removed run parallel to Placements
+    const int32 Num = Tile.Placements.Num();
+    Tile.Actors.Reset(Num);
+    Tile.Actors.SetNum(Num);
+    if (Tile.Removed.Num() != Num)
+    {
+        Tile.Removed.Init(false, Num);
+    }
+    Tile.Occluded.Init(false, Num);
+    if (!R.ActorClass) return;
 
-            if (AActor* SpawnedActor = GetWorld()->SpawnActor<AActor>(R.ActorClass, T, P))
+    for (int32 Slot = 0; Slot < Num; ++Slot)
+    {
+        if (Tile.Removed[Slot]) continue;
+        Tile.Actors[Slot] = AcquireActor(R.ActorClass, Tile.Placements[Slot]);
+    }
+
+    IndexTile(RequestIndex, TileIndex);
+}
+
+AActor* AScatterSpawner::AcquireActor(UClass* Class, const FTransform& T)
+{
+    // Reuse a released actor of the same class: one transform update, already attached
+    if (TArray<TWeakObjectPtr<AActor>>* Pool = ActorPool.Find(Class))
+    {
+        while (Pool->Num() > 0)
+        {
+            if (AActor* A = Pool->Pop(EAllowShrinking::No).Get())
             {
-                SpawnedActors.Add(SpawnedActor);
-                SpawnedActor->SetActorScale3D(FVector(ScaleU));
-                Placed2D.Add(FVector2D(WorldOnPlane.X, WorldOnPlane.Y));
-                ++Spawned;
+#if WITH_EDITOR
+                A->Modify();
+#endif
+                A->SetActorTransform(T, /*bSweep=*/false, nullptr, ETeleportType::ResetPhysics);
 
-                if (AActor* Parent = SpawnContainer)
+                // May have been released while hidden by ApplyOcclusion
+                if (A->IsHidden())
                 {
-                    if (USceneComponent* ParentRoot = Parent->GetRootComponent())
-                    {
-                        const FAttachmentTransformRules Rules = FAttachmentTransformRules::KeepWorldTransform;
-                        SpawnedActor->AttachToComponent(ParentRoot, Rules);
-                    }
-                    else
-                    {
-                        UE_LOG(LogTemp, Warning, TEXT("SpawnContainer has no RootComponent; cannot attach %s"),
-                            *SpawnedActor->GetName());
-                    }
+                    A->SetActorHiddenInGame(false);
                 }
+                return A;
+            }
+        }
+    }
+
+    // New actor: construction and registration wait for CommitSpawns
+    AActor* A = GetWorld()->SpawnActorDeferred<AActor>(Class, T, nullptr, nullptr,
+        ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn);
+    if (A)
+    {
+        PendingSpawns.Emplace(A, T);
+    }
+    return A;
+}
+
+bool AScatterSpawner::CommitSpawns(double DeadlineSeconds)
+{
+    if (PendingSpawns.Num() == 0) return true;
+
+    USceneComponent* ParentRoot = SpawnContainer ? SpawnContainer->GetRootComponent() : nullptr;
+    if (SpawnContainer && !ParentRoot && PendingSpawnCursor == 0)
+    {
+        UE_LOG(LogTemp, Warning, TEXT("ScatterSpawner: SpawnContainer has no RootComponent; %d actors left unattached"),
+            PendingSpawns.Num());
+    }
+
+    // Spawn transform (incl. scale) goes in once at registration; attaching keeps it
+    while (PendingSpawnCursor < PendingSpawns.Num())
+    {
+        const TPair<AActor*, FTransform>& Pending = PendingSpawns[PendingSpawnCursor++];
+        AActor* A = Pending.Key;
+        A->FinishSpawning(Pending.Value);
+        if (ParentRoot && IsValid(A))
+        {
+            A->AttachToComponent(ParentRoot, FAttachmentTransformRules::KeepWorldTransform);
+        }
+        if (FPlatformTime::Seconds() >= DeadlineSeconds && PendingSpawnCursor < PendingSpawns.Num())
+        {
+            return false;
+        }
+    }
+    PendingSpawns.Reset();
+    PendingSpawnCursor = 0;
+    return true;
+}
+
+void AScatterSpawner::ReleaseActor(AActor* A)
+{
+    if (!IsValid(A)) return;
+
+    if (bPoolActors)
+    {
+        ActorPool.FindOrAdd(A->GetClass()).Add(A);
+        return;
+    }
+
+#if WITH_EDITOR
+    A->Modify();
+#endif
+    A->Destroy();
+}
 
+void AScatterSpawner::FlushPool()
+{
+    // Whatever wasn't reused is the surplus
+    int32 Destroyed = 0;
+    for (TPair<UClass*, TArray<TWeakObjectPtr<AActor>>>& Entry : ActorPool)
+    {
+        for (const TWeakObjectPtr<AActor>& W : Entry.Value)
+        {
+            if (AActor* A = W.Get())
+            {
+#if WITH_EDITOR
+                A->Modify();
+#endif
+                A->Destroy();
+                ++Destroyed;
             }
         }
+    }
+    ActorPool.Reset();
 
-        UE_LOG(LogTemp, Log, TEXT("ScatterSpawner: %d/%d spawned for %s (tries=%d)"),
-            Spawned, R.Count, *R.ActorClass->GetName(), Tries);
+    if (Destroyed > 0)
+    {
+        UE_LOG(LogTemp, Log, TEXT("ScatterSpawner: destroyed %d surplus actors"), Destroyed);
     }
 }
 
-bool AScatterSpawner::AcceptByConstraints(const FSpawnRequest& R, float X, float Y, float& OutZ, FVector& OutNormal) const
+void AScatterSpawner::ReleaseTile(int32 RequestIndex, int32 TileIndex)
 {
-    if (!Terrain) return false;
+    UnindexTile(RequestIndex, TileIndex);
+
+    FScatterTile& Tile = RequestStates[RequestIndex].Tiles[TileIndex];
+    for (TWeakObjectPtr<AActor>& W : Tile.Actors)
+    {
+        ReleaseActor(W.Get());
+    }
+    Tile.Actors.Reset();
+    Tile.Placements.Reset();
+    Tile.Removed.Reset();
+    Tile.Occluded.Reset();
+    Tile.IndexBuckets.Reset();
+}
+
+void AScatterSpawner::ReleaseRequest(int32 RequestIndex)
+{
+    FScatterRequestState& State = RequestStates[RequestIndex];
+    for (int32 t = 0; t < State.Tiles.Num(); ++t)
+    {
+        ReleaseTile(RequestIndex, t);
+    }
+    State.Tiles.Reset();
+    State.SettingsHash = 0;
+}
+
+void AScatterSpawner::ResetInstanceIndex()
+{
+    IndexCellExtent = FMath::Max(IndexCellSize, 100.f);
+    IndexOrigin = ScatterMin;
+    IndexCellsX = FMath::Max(FMath::CeilToInt((ScatterMax.X - ScatterMin.X) / IndexCellExtent), 1);
+    IndexCellsY = FMath::Max(FMath::CeilToInt((ScatterMax.Y - ScatterMin.Y) / IndexCellExtent), 1);
+
+    IndexCells.Reset();
+    IndexCells.SetNum(IndexCellsX * IndexCellsY);
+}
+
+FIntPoint AScatterSpawner::GetIndexCoord(const FVector2f& LocalXY) const
+{
+    return FIntPoint(
+        FMath::Clamp(FMath::FloorToInt((LocalXY.X - (float)IndexOrigin.X) / IndexCellExtent), 0, IndexCellsX - 1),
+        FMath::Clamp(FMath::FloorToInt((LocalXY.Y - (float)IndexOrigin.Y) / IndexCellExtent), 0, IndexCellsY - 1));
+}
+
+void AScatterSpawner::IndexTile(int32 RequestIndex, int32 TileIndex)
+{
+    if (IndexCells.Num() == 0) return;
+
+    FScatterTile& Tile = RequestStates[RequestIndex].Tiles[TileIndex];
+    const FTransform& TerrainXform = Terrain->GetActorTransform();
+
+    // Remembered per slot: SurfaceOffset can push a placement any distance from its tile
+    Tile.IndexBuckets.Init(INDEX_NONE, Tile.Placements.Num());
+
+    for (int32 Slot = 0; Slot < Tile.Placements.Num(); ++Slot)
+    {
+        if (Tile.Removed[Slot]) continue;
+
+        const FVector L = TerrainXform.InverseTransformPosition(Tile.Placements[Slot].GetLocation());
+        FScatterInstanceRef Ref;
+        Ref.LocalXY = FVector2f((float)L.X, (float)L.Y);
+        Ref.Request = RequestIndex;
+        Ref.Tile = TileIndex;
+        Ref.Slot = Slot;
+
+        const FIntPoint C = GetIndexCoord(Ref.LocalXY);
+        Tile.IndexBuckets[Slot] = C.Y * IndexCellsX + C.X;
+        IndexCells[Tile.IndexBuckets[Slot]].Add(Ref);
+    }
+}
+
+void AScatterSpawner::UnindexSlot(int32 RequestIndex, int32 TileIndex, int32 Slot)
+{
+    FScatterTile& Tile = RequestStates[RequestIndex].Tiles[TileIndex];
+    if (!Tile.IndexBuckets.IsValidIndex(Slot) || Tile.IndexBuckets[Slot] == INDEX_NONE) return;
+
+    TArray<FScatterInstanceRef>& Cell = IndexCells[Tile.IndexBuckets[Slot]];
+    Tile.IndexBuckets[Slot] = INDEX_NONE;
+
+    const int32 At = Cell.IndexOfByPredicate([RequestIndex, TileIndex, Slot](const FScatterInstanceRef& Ref)
+    {
+        return Ref.Request == RequestIndex && Ref.Tile == TileIndex && Ref.Slot == Slot;
+    });
+    if (At != INDEX_NONE)
+    {
+        Cell.RemoveAtSwap(At, 1, EAllowShrinking::No);
+    }
+}
+
+void AScatterSpawner::UnindexTile(int32 RequestIndex, int32 TileIndex)
+{
+    if (IndexCells.Num() == 0) return;
+
+    const FScatterTile& Tile = RequestStates[RequestIndex].Tiles[TileIndex];
+    for (int32 Slot = 0; Slot < Tile.IndexBuckets.Num(); ++Slot)
+    {
+        UnindexSlot(RequestIndex, TileIndex, Slot);
+    }
+}
 
+void AScatterSpawner::GatherInstances(const FVector2f& LocalMin, const FVector2f& LocalMax,
+    TFunctionRef<bool(const FVector2f& LocalXY)> Inside, TArray<FIntVector>& OutRefs) const
+{
+    OutRefs.Reset();
+    if (IndexCells.Num() == 0) return;
+
+    const FIntPoint C0 = GetIndexCoord(LocalMin);
+    const FIntPoint C1 = GetIndexCoord(LocalMax);
+    for (int32 cy = C0.Y; cy <= C1.Y; ++cy)
+    {
+        for (int32 cx = C0.X; cx <= C1.X; ++cx)
+        {
+            for (const FScatterInstanceRef& Ref : IndexCells[cy * IndexCellsX + cx])
+            {
+                if (!IsLiveRef(Ref)) continue;
+                if (Inside(Ref.LocalXY))
+                {
+                    OutRefs.Add(FIntVector(Ref.Request, Ref.Tile, Ref.Slot));
+                }
+            }
+        }
+    }
+}
+
+int32 AScatterSpawner::RemoveGathered(const TArray<FIntVector>& Refs)
+{
+    for (const FIntVector& R : Refs)
+    {
+        FScatterTile& Tile = RequestStates[R.X].Tiles[R.Y];
+        ReleaseActor(Tile.Actors[R.Z].Get());
+        Tile.Actors[R.Z] = nullptr;
+        Tile.Removed[R.Z] = true;
+        UnindexSlot(R.X, R.Y, R.Z);
+    }
+
+    // Pooled releases are destroyed right away; nothing is going to reuse them
+    FlushPool();
+    return Refs.Num();
+}
+
+int32 AScatterSpawner::RemoveInstancesInRadius(FVector WorldCenter, float Radius)
+{
+    if (!Terrain || Radius <= 0.f) return 0;
+
+    const FVector L = Terrain->GetActorTransform().InverseTransformPosition(WorldCenter);
+    const FVector2f C((float)L.X, (float)L.Y);
+    const float R2 = Radius * Radius;
+
+    TArray<FIntVector> Refs;
+    GatherInstances(C - FVector2f(Radius, Radius), C + FVector2f(Radius, Radius),
+        [C, R2](const FVector2f& P) { return FVector2f::DistSquared(P, C) <= R2; }, Refs);
+    return RemoveGathered(Refs);
+}
+
+int32 AScatterSpawner::RemoveInstancesInFootprint(FVector WorldCenter, FVector2D HalfExtent)
+{
+    if (!Terrain) return 0;
+
+    const FVector L = Terrain->GetActorTransform().InverseTransformPosition(WorldCenter);
+    const FVector2f Min((float)(L.X - HalfExtent.X), (float)(L.Y - HalfExtent.Y));
+    const FVector2f Max((float)(L.X + HalfExtent.X), (float)(L.Y + HalfExtent.Y));
+
+    TArray<FIntVector> Refs;
+    GatherInstances(Min, Max,
+        [Min, Max](const FVector2f& P) { return P.X >= Min.X && P.X <= Max.X && P.Y >= Min.Y && P.Y <= Max.Y; }, Refs);
+    return RemoveGathered(Refs);
+}
+
+int32 AScatterSpawner::QueryInstancesInRadius(FVector WorldCenter, float Radius, TArray<AActor*>& OutActors) const
+{
+    OutActors.Reset();
+    if (!Terrain || Radius <= 0.f) return 0;
+
+    const FVector L = Terrain->GetActorTransform().InverseTransformPosition(WorldCenter);
+    const FVector2f C((float)L.X, (float)L.Y);
+    const float R2 = Radius * Radius;
+
+    TArray<FIntVector> Refs;
+    GatherInstances(C - FVector2f(Radius, Radius), C + FVector2f(Radius, Radius),
+        [C, R2](const FVector2f& P) { return FVector2f::DistSquared(P, C) <= R2; }, Refs);
+
+    for (const FIntVector& R : Refs)
+    {
+        if (AActor* A = RequestStates[R.X].Tiles[R.Y].Actors[R.Z].Get())
+        {
+            OutActors.Add(A);
+        }
+    }
+    return OutActors.Num();
+}
+
+int32 AScatterSpawner::ApplyOcclusion(const FTerrainHorizonOcclusion* Occlusion, float InstanceHeight)
+{
+    const bool bCull = Occlusion && Occlusion->IsValid();
+
+    int32 NumHidden = 0;
+    for (const TArray<FScatterInstanceRef>& Cell : IndexCells)
+    {
+        for (const FScatterInstanceRef& Ref : Cell)
+        {
+            if (!IsLiveRef(Ref)) continue;
+
+            FScatterTile& Tile = RequestStates[Ref.Request].Tiles[Ref.Tile];
+            const bool bOccluded = bCull && Occlusion->IsColumnOccluded(Ref.LocalXY.X, Ref.LocalXY.Y, InstanceHeight);
+            NumHidden += bOccluded ? 1 : 0;
+
+            if (Tile.Occluded[Ref.Slot] == bOccluded) continue;
+            Tile.Occluded[Ref.Slot] = bOccluded;
+
+            if (AActor* A = Tile.Actors[Ref.Slot].Get())
+            {
+                A->SetActorHiddenInGame(bOccluded);
+            }
+        }
+    }
+    return NumHidden;
+}
+
+uint64 AScatterSpawner::GetLayoutHash() const
+{
+    // Everything shared by all requests: our seed/region/tiling, the terrain's heights/water and where it sits
+    TArray<uint8> Blob;
+    FMemoryWriter Ar(Blob);
+    auto Put = [&Ar](auto Value) { Ar << Value; };
+
+    Put(ScatterCacheVersion);
+    Put(Seed);
+    Put(ScatterMin); Put(ScatterMax); Put(ScatterTileSize);
+
+    Put(Terrain->GetGenerationHash());
+    Put(Terrain->GetActorTransform());
+    Put(Terrain->WaterZ);
+    Put(Terrain->bEnableFlatten); Put(Terrain->FlattenCenter); Put(Terrain->FlattenSize);
+
+    return CityHash64(reinterpret_cast<const char*>(Blob.GetData()), Blob.Num());
+}
+
+uint64 AScatterSpawner::HashRequest(const FSpawnRequest& R)
+{
+    TArray<uint8> Blob;
+    FMemoryWriter Ar(Blob);
+    auto Put = [&Ar](auto Value) { Ar << Value; };
+
+    Put(R.Id);
+    Put(R.ActorClass ? R.ActorClass->GetPathName() : FString());
+    Put(R.Count); Put(R.MinZ); Put(R.MaxZ); Put(R.MinSlopeDeg); Put(R.MaxSlopeDeg);
+    Put(R.MinSpacing); Put(R.SurfaceOffset); Put(R.bRandomYaw); Put(R.UniformScaleRange);
+    Put(R.MaxTriesPerInstance); Put(R.bDisallowBelowWater);
+    Put(R.bUseShoreDistance); Put(R.MinShoreDistance); Put(R.MaxShoreDistance);
+    Put(R.bDisallowOnFlattenCore); Put(R.FlattenCoreExtra);
+
+    return CityHash64(reinterpret_cast<const char*>(Blob.GetData()), Blob.Num());
+}
+
+uint64 AScatterSpawner::GetScatterHash() const
+{
+    uint64 Hash = GetLayoutHash();
+    for (const FSpawnRequest& R : Requests)
+    {
+        Hash = CityHash128to64(Uint128_64(Hash, HashRequest(R)));
+    }
+    return Hash;
+}
+
+FString AScatterSpawner::GetScatterCachePath(uint64 Hash) const
+{
+    return FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("ScatterCache"),
+        FString::Printf(TEXT("%016llx.scatter"), Hash));
+}
+
+bool AScatterSpawner::LoadScatterCache(uint64 Hash)
+{
+    TArray<uint8> Bytes;
+    if (!FFileHelper::LoadFileToArray(Bytes, *GetScatterCachePath(Hash), FILEREAD_Silent))
+    {
+        return false;
+    }
+
+    FMemoryReader Ar(Bytes);
+    uint32 Magic = 0;
+    int32 Version = 0;
+    uint64 StoredHash = 0;
+    int32 NumRequests = 0;
+    int32 NumTiles = 0;
+    Ar << Magic << Version << StoredHash << NumRequests << NumTiles;
+
+    if (Ar.IsError() || Magic != ScatterCacheMagic || Version != ScatterCacheVersion ||
+        StoredHash != Hash || NumRequests != Requests.Num() || NumTiles != ScatterTilesX * ScatterTilesY)
+    {
+        return false;
+    }
+
+    TArray<FScatterRequestState> Loaded;
+    Loaded.SetNum(NumRequests);
+    for (int32 i = 0; i < NumRequests; ++i)
+    {
+        Loaded[i].Id = Requests[i].Id;
+        Loaded[i].SettingsHash = HashRequest(Requests[i]);
+        Loaded[i].Tiles.SetNum(NumTiles);
+
+        for (FScatterTile& Tile : Loaded[i].Tiles)
+        {
+            int32 Num = 0;
+            Ar << Num;
+
+            // Each instance is 8 floats: location, rotation, uniform scale
+            if (Ar.IsError() || Num < 0 || Ar.TotalSize() - Ar.Tell() < (int64)Num * 8 * sizeof(float))
+            {
+                return false;
+            }
+
+            Tile.Placements.SetNumUninitialized(Num);
+            for (FTransform& T : Tile.Placements)
+            {
+                FVector3f Loc;
+                FQuat4f Rot;
+                float Scale = 1.f;
+                Ar << Loc << Rot << Scale;
+                T = FTransform(FQuat(Rot), FVector(Loc), FVector(Scale));
+            }
+        }
+    }
+
+    if (Ar.IsError()) return false;
+    RequestStates = MoveTemp(Loaded);
+    return true;
+}
+
+void AScatterSpawner::SaveScatterCache(uint64 Hash) const
+{
+    const int32 NumTiles = ScatterTilesX * ScatterTilesY;
+
+    int32 Total = 0;
+    for (const FScatterRequestState& State : RequestStates)
+    {
+        // Only complete states can be written
+        if (State.Tiles.Num() != NumTiles) return;
+        for (const FScatterTile& Tile : State.Tiles) Total += Tile.Placements.Num();
+    }
+
+    TArray<uint8> Bytes;
+    Bytes.Reserve(32 + RequestStates.Num() * NumTiles * sizeof(int32) + Total * 8 * sizeof(float));
+    FMemoryWriter Ar(Bytes);
+
+    uint32 Magic = ScatterCacheMagic;
+    int32 Version = ScatterCacheVersion;
+    int32 NumRequests = RequestStates.Num();
+    int32 Tiles = NumTiles;
+    Ar << Magic << Version << Hash << NumRequests << Tiles;
+
+    for (const FScatterRequestState& State : RequestStates)
+    {
+        for (const FScatterTile& Tile : State.Tiles)
+        {
+            int32 Num = Tile.Placements.Num();
+            Ar << Num;
+            for (const FTransform& T : Tile.Placements)
+            {
+                // Float precision is plenty for placement (sub-mm out to tens of km)
+                FVector3f Loc(T.GetLocation());
+                FQuat4f Rot(T.GetRotation());
+                float Scale = (float)T.GetScale3D().X;
+                Ar << Loc << Rot << Scale;
+            }
+        }
+    }
+
+    if (!FFileHelper::SaveArrayToFile(Bytes, *GetScatterCachePath(Hash)))
+    {
+        UE_LOG(LogTemp, Warning, TEXT("ScatterSpawner: failed to write scatter cache %s"), *GetScatterCachePath(Hash));
+    }
+}
+
+bool AScatterSpawner::AcceptByConstraints(const FTerrainSnapshot& Ground, const FSpawnRequest& R, float X, float Y, float& OutZ, FVector& OutNormal,
+    EScatterRejectReason& OutReason) const
+{
     // --- Reject if inside the terrain's central platform (optionally inflated) ---
-    if (R.bDisallowOnFlattenCore && Terrain->bEnableFlatten)
+    if (R.bDisallowOnFlattenCore && Ground.bEnableFlatten)
     {
         // World (X,Y) -> Terrain local (lx, ly)
-        const FVector Local = Terrain->GetActorTransform()
+        const FVector Local = Ground.ActorTransform
             .InverseTransformPosition(FVector(X, Y, 0.f));
         const float lx = Local.X;
         const float ly = Local.Y;
 
         // Core center & size FROM THE TERRAIN
-        const float Cx = Terrain->FlattenCenter.X;
-        const float Cy = Terrain->FlattenCenter.Y;
+        const float Cx = Ground.FlattenCenter.X;
+        const float Cy = Ground.FlattenCenter.Y;
 
         // Inflate half-extents by FlattenCoreExtra
-        const float hx = 0.5f * FMath::Max(0.f, Terrain->FlattenSize.X) + R.FlattenCoreExtra;
-        const float hy = 0.5f * FMath::Max(0.f, Terrain->FlattenSize.Y) + R.FlattenCoreExtra;
+        const float hx = 0.5f * FMath::Max(0.f, Ground.FlattenSize.X) + R.FlattenCoreExtra;
+        const float hy = 0.5f * FMath::Max(0.f, Ground.FlattenSize.Y) + R.FlattenCoreExtra;
 
         // Inside axis-aligned rectangle?
         const bool bInside =
             (FMath::Abs(lx - Cx) <= hx) &&
             (FMath::Abs(ly - Cy) <= hy);
 
+        OutReason = EScatterRejectReason::FlattenCore;
         if (bInside)
             return false; // reject this spawn
     }
 
-    const float z = Terrain->GetHeightAtWorldXY(X, Y, /*bClampToBounds*/true);
+    const float z = Ground.GetHeightAtWorldXY(X, Y, /*bClampToBounds*/true);
     OutZ = z;
 
 
 
     // Z window
+    OutReason = EScatterRejectReason::Height;
     if (z < R.MinZ || z > R.MaxZ) return false;
 
     // Optional: below water rejection
-    if (R.bDisallowBelowWater && z < Terrain->WaterZ) return false;
+    OutReason = EScatterRejectReason::Water;
+    if (R.bDisallowBelowWater && z < Ground.WaterZ) return false;
 
-    // Always compute normal (we use it for alignment)
-    OutNormal = Terrain->GetNormalAtWorldXY(X, Y, /*bClamp*/true).GetSafeNormal();
-    OutNormal.Normalize();
-    if (OutNormal.Z < 0.f)
+    // Optional: shore distance window (reeds at the waterline, rocks inland, ...)
+    if (R.bUseShoreDistance)
     {
-        OutNormal *= -1.f;  // force up-facing
+        const float Shore = Ground.GetShoreDistanceAtWorldXY(X, Y);
+        OutReason = EScatterRejectReason::Shore;
+        if (Shore < R.MinShoreDistance || Shore > R.MaxShoreDistance) return false;
     }
 
+    // Always compute normal (we use it for alignment)
+    OutNormal = Ground.GetNormalAtWorldXY(X, Y, /*bClamp*/true);
+
     // Slope constraint (optional)
     if (R.MinSlopeDeg > 0.f || R.MaxSlopeDeg < 90.f)
     {
         const float slopeRad = FMath::Acos(FMath::Clamp(OutNormal.Z, -1.f, 1.f));
         const float slopeDeg = FMath::RadiansToDegrees(slopeRad);
+        OutReason = EScatterRejectReason::Slope;
         if (slopeDeg < R.MinSlopeDeg || slopeDeg > R.MaxSlopeDeg) return false;
     }
 
@@ -0,0 +1,231 @@
+#include "TerrainDebugOverlay.h"
+#include "TerrainSnapshot.h"
+#include "TerrainMeshComponent.h"
+#include "Async/ParallelFor.h"
+
+namespace
+{
+    const FLinearColor OverlayLow(0.05f, 0.25f, 1.f);
+    const FLinearColor OverlayMid(0.1f, 0.9f, 0.1f);
+    const FLinearColor OverlayHigh(1.f, 0.1f, 0.05f);
+    const FLinearColor OverlayEmpty(0.04f, 0.04f, 0.04f);
+
+    // Every other band slightly darker so band edges read at any zoom
+    FLinearColor Banded(const FLinearColor& C, int32 Band)
+    {
+        return (Band & 1) ? C * 0.8f : C;
+    }
+}
+
+void FScatterRejectionMap::Init(const FVector2f& Min, const FVector2f& Max, float InCellSize)
+{
+    CellSize = FMath::Max(InCellSize, 1.f);
+    Origin = Min;
+    CellsX = FMath::Max(FMath::CeilToInt((Max.X - Min.X) / CellSize), 1);
+    CellsY = FMath::Max(FMath::CeilToInt((Max.Y - Min.Y) / CellSize), 1);
+    Counts.SetNumZeroed(CellsX * CellsY * NumReasons);
+}
+
+void FScatterRejectionMap::Reset()
+{
+    CellsX = CellsY = 0;
+    Counts.Reset();
+}
+
+void FScatterRejectionMap::Add(float LocalX, float LocalY, EScatterRejectReason Reason)
+{
+    if (!IsValid()) return;
+
+    const int32 cx = FMath::FloorToInt((LocalX - Origin.X) / CellSize);
+    const int32 cy = FMath::FloorToInt((LocalY - Origin.Y) / CellSize);
+    if (cx < 0 || cy < 0 || cx >= CellsX || cy >= CellsY) return;
+
+    FPlatformAtomics::InterlockedIncrement(&Counts[(cy * CellsX + cx) * NumReasons + (int32)Reason]);
+}
+
+int32 FScatterRejectionMap::Sample(float LocalX, float LocalY, EScatterRejectReason& OutDominant) const
+{
+    OutDominant = EScatterRejectReason::Count;
+    if (!IsValid()) return 0;
+
+    const int32 cx = FMath::FloorToInt((LocalX - Origin.X) / CellSize);
+    const int32 cy = FMath::FloorToInt((LocalY - Origin.Y) / CellSize);
+    if (cx < 0 || cy < 0 || cx >= CellsX || cy >= CellsY) return 0;
+
+    const int32* Cell = &Counts[(cy * CellsX + cx) * NumReasons];
+    int32 Total = 0;
+    int32 Best = 0;
+    for (int32 r = 0; r < NumReasons; ++r)
+    {
+        Total += Cell[r];
+        if (Cell[r] > Best)
+        {
+            Best = Cell[r];
+            OutDominant = (EScatterRejectReason)r;
+        }
+    }
+    return Total;
+}
+
+int32 FScatterRejectionMap::GetMaxCellTotal() const
+{
+    int32 Max = 0;
+    for (int32 c = 0; c < Counts.Num(); c += NumReasons)
+    {
+        int32 Total = 0;
+        for (int32 r = 0; r < NumReasons; ++r)
+        {
+            Total += Counts[c + r];
+        }
+        Max = FMath::Max(Max, Total);
+    }
+    return Max;
+}
+
+FLinearColor FTerrainDebugOverlay::GetReasonColor(EScatterRejectReason Reason)
+{
+    switch (Reason)
+    {
+    case EScatterRejectReason::FlattenCore: return FLinearColor(1.f, 1.f, 1.f);
+    case EScatterRejectReason::Height:      return FLinearColor(1.f, 0.55f, 0.f);
+    case EScatterRejectReason::Water:       return FLinearColor(0.f, 0.35f, 1.f);
+    case EScatterRejectReason::Shore:       return FLinearColor(0.f, 0.9f, 0.9f);
+    case EScatterRejectReason::Slope:       return FLinearColor(1.f, 0.05f, 0.05f);
+    case EScatterRejectReason::Spacing:     return FLinearColor(0.8f, 0.f, 1.f);
+    default:                                return OverlayEmpty;
+    }
+}
+
+void FTerrainDebugOverlay::Build(const FTerrainSnapshot& Ground, const FTerrainDebugOverlaySettings& Settings,
+    const FScatterRejectionMap* Rejections, FTerrainMeshData& Out)
+{
+    // Fields set one by one so Out's arrays keep their capacity across rebuilds
+    Out.NumQuadsX = Out.NumQuadsY = 0;
+    if (!Ground.IsValid())
+    {
+        Out.Heights.Reset();
+        Out.Normals.Reset();
+        Out.Colors.Reset();
+        return;
+    }
+
+    const int32 Stride = FMath::Max(Settings.Stride, 1);
+    const int32 SrcQuadsX = Ground.NumQuadsX;
+    const int32 SrcQuadsY = Ground.NumQuadsY;
+    const int32 SrcVertsX = SrcQuadsX + 1;
+    const float Spacing = Ground.GridSpacing;
+    const float HalfW = SrcQuadsX * Spacing * 0.5f;
+    const float HalfH = SrcQuadsY * Spacing * 0.5f;
+
+    Out.NumQuadsX = FMath::DivideAndRoundUp(SrcQuadsX, Stride);
+    Out.NumQuadsY = FMath::DivideAndRoundUp(SrcQuadsY, Stride);
+    Out.GridSpacing = Spacing * Stride;
+    Out.TileQuads = Settings.TileQuads;
+
+    const int32 VertsX = Out.NumQuadsX + 1;
+    const int32 VertsY = Out.NumQuadsY + 1;
+    Out.Heights.SetNumUninitialized(VertsX * VertsY, EAllowShrinking::No);
+    Out.Normals.SetNumUninitialized(VertsX * VertsY, EAllowShrinking::No);
+    Out.Colors.SetNumUninitialized(VertsX * VertsY, EAllowShrinking::No);
+
+    // Mode-wide ranges
+    float MinZ = 0.f, MaxZ = 0.f;
+    if (Settings.Mode == ETerrainDebugOverlay::Height)
+    {
+        MinZ = MaxZ = Ground.Heights[0];
+        for (const float H : Ground.Heights)
+        {
+            MinZ = FMath::Min(MinZ, H);
+            MaxZ = FMath::Max(MaxZ, H);
+        }
+    }
+    const bool bHasRejections = Settings.Mode == ETerrainDebugOverlay::ScatterRejections && Rejections && Rejections->IsValid();
+    const int32 MaxRejections = bHasRejections ? FMath::Max(Rejections->GetMaxCellTotal(), 1) : 1;
+
+    const float SlopeBand = FMath::Max(Settings.SlopeBandDeg, 0.1f);
+    const float HeightBand = FMath::Max(Settings.HeightBandSize, 1.f);
+    const float NavMaxSlope = FMath::Clamp(Settings.NavMaxSlopeDeg, 1.f, 90.f);
+
+    auto SrcHeight = [&](int32 X, int32 Y)
+    {
+        return Ground.Heights[FMath::Clamp(Y, 0, SrcQuadsY) * SrcVertsX + FMath::Clamp(X, 0, SrcQuadsX)];
+    };
+
+    ParallelFor(VertsY, [&](int32 y)
+    {
+        const int32 sy = FMath::Min(y * Stride, SrcQuadsY);
+        for (int32 x = 0; x < VertsX; ++x)
+        {
+            const int32 sx = FMath::Min(x * Stride, SrcQuadsX);
+            const int32 i = y * VertsX + x;
+            const float H = SrcHeight(sx, sy);
+
+            // Central differences on the full-resolution grid (one-sided at the border)
+            const int32 x0 = FMath::Max(sx - 1, 0), x1 = FMath::Min(sx + 1, SrcQuadsX);
+            const int32 y0 = FMath::Max(sy - 1, 0), y1 = FMath::Min(sy + 1, SrcQuadsY);
+            const float DZDX = (SrcHeight(x1, sy) - SrcHeight(x0, sy)) / ((x1 - x0) * Spacing);
+            const float DZDY = (SrcHeight(sx, y1) - SrcHeight(sx, y0)) / ((y1 - y0) * Spacing);
+            const FVector3f N = FVector3f(-DZDX, -DZDY, 1.f).GetSafeNormal();
+            const float SlopeDeg = FMath::RadiansToDegrees(FMath::Acos(FMath::Clamp(N.Z, -1.f, 1.f)));
+
+            FLinearColor C = OverlayEmpty;
+            switch (Settings.Mode)
+            {
+            case ETerrainDebugOverlay::Normals:
+                C = FLinearColor(N.X * 0.5f + 0.5f, N.Y * 0.5f + 0.5f, N.Z * 0.5f + 0.5f);
+                break;
+
+            case ETerrainDebugOverlay::Slope:
+            {
+                const int32 Band = FMath::FloorToInt(SlopeDeg / SlopeBand);
+                const float t = FMath::Clamp(Band * SlopeBand / 60.f, 0.f, 1.f);
+                C = Banded(FLinearColor::LerpUsingHSV(OverlayMid, OverlayHigh, t), Band);
+                break;
+            }
+
+            case ETerrainDebugOverlay::Height:
+            {
+                const int32 Band = FMath::FloorToInt(H / HeightBand);
+                const float t = MaxZ > MinZ ? FMath::Clamp((Band * HeightBand - MinZ) / (MaxZ - MinZ), 0.f, 1.f) : 0.f;
+                C = Banded(FLinearColor::LerpUsingHSV(OverlayLow, OverlayHigh, t), Band);
+                if (H < Ground.WaterZ) C *= 0.4f;
+                break;
+            }
+
+            case ETerrainDebugOverlay::ScatterRejections:
+                if (bHasRejections)
+                {
+                    EScatterRejectReason Dominant;
+                    const int32 Total = Rejections->Sample(sx * Spacing - HalfW, sy * Spacing - HalfH, Dominant);
+                    if (Total > 0)
+                    {
+                        // sqrt so sparse cells still show against the hottest one
+                        const float t = FMath::Sqrt((float)Total / (float)MaxRejections);
+                        C = FMath::Lerp(OverlayEmpty, GetReasonColor(Dominant), FMath::Max(t, 0.15f));
+                    }
+                }
+                break;
+
+            case ETerrainDebugOverlay::NavigationCost:
+                if (H < Ground.WaterZ || SlopeDeg > NavMaxSlope)
+                {
+                    C = FLinearColor::Black;
+                }
+                else
+                {
+                    C = FLinearColor::LerpUsingHSV(OverlayMid, OverlayHigh, FMath::Square(SlopeDeg / NavMaxSlope));
+                }
+                break;
+
+            default:
+                break;
+            }
+
+            Out.Heights[i] = H;
+            Out.Normals[i] = FPackedNormal(N);
+            Out.Colors[i] = C.ToFColor(/*bSRGB=*/true);
+        }
+    });
+
+    Out.RecomputeBounds();
+}
@@ -0,0 +1,282 @@
+#include "TerrainErosion.h"
+#include "Async/ParallelFor.h"
+#include "Math/RandomStream.h"
+
+namespace
+{
+    // 64x64 floats = 16 KB per tile, comfortably L1/L2 resident while droplets run
+    constexpr int32 ErosionTileSize = 64;
+    constexpr int32 ThermalRowsPerBlock = 16;
+
+    struct FErosionBrush
+    {
+        TArray<FIntPoint> Offsets;
+        TArray<float> Weights;
+    };
+
+    FErosionBrush MakeBrush(int32 Radius)
+    {
+        FErosionBrush Brush;
+        float WeightSum = 0.f;
+        for (int32 y = -Radius; y <= Radius; ++y)
+        {
+            for (int32 x = -Radius; x <= Radius; ++x)
+            {
+                const float Dist = FMath::Sqrt((float)(x * x + y * y));
+                if (Dist > Radius) continue;
+                const float W = 1.f - Dist / (float)(Radius + 1);
+                Brush.Offsets.Add(FIntPoint(x, y));
+                Brush.Weights.Add(W);
+                WeightSum += W;
+            }
+        }
+        for (float& W : Brush.Weights) { W /= WeightSum; }
+        return Brush;
+    }
+
+    // Bilinear height + gradient at a fractional grid position
+    FORCEINLINE void HeightAndGradient(const float* H, int32 VertsX, float X, float Y,
+        float& OutHeight, float& OutGX, float& OutGY)
+    {
+        const int32 CX = (int32)X;
+        const int32 CY = (int32)Y;
+        const float U = X - CX;
+        const float V = Y - CY;
+
+        const int32 I = CY * VertsX + CX;
+        const float H00 = H[I];
+        const float H10 = H[I + 1];
+        const float H01 = H[I + VertsX];
+        const float H11 = H[I + VertsX + 1];
+
+        OutGX = (H10 - H00) * (1.f - V) + (H11 - H01) * V;
+        OutGY = (H01 - H00) * (1.f - U) + (H11 - H10) * U;
+        OutHeight = H00 * (1.f - U) * (1.f - V) + H10 * U * (1.f - V) + H01 * (1.f - U) * V + H11 * U * V;
+    }
+}
+
+void FTerrainErosion::Erode(TArray<float>& Heights, int32 VertsX, int32 VertsY, float GridSpacing,
+    int32 Seed, const FTerrainErosionSettings& Settings)
+{
+    FTerrainErosionScratch Scratch;
+    Erode(Heights, VertsX, VertsY, GridSpacing, Seed, Settings, Scratch);
+}
+
+void FTerrainErosion::Erode(TArray<float>& Heights, int32 VertsX, int32 VertsY, float GridSpacing,
+    int32 Seed, const FTerrainErosionSettings& Settings, FTerrainErosionScratch& Scratch)
+{
+    if (VertsX < 2 || VertsY < 2 || Heights.Num() != VertsX * VertsY) return;
+
+    // Droplet constants are tuned for heights normalized to ~[0,1]; simulate in that space
+    float MinH = Heights[0], MaxH = Heights[0];
+    for (const float H : Heights)
+    {
+        MinH = FMath::Min(MinH, H);
+        MaxH = FMath::Max(MaxH, H);
+    }
+    const float Range = FMath::Max(MaxH - MinH, 1.f);
+    const float InvRange = 1.f / Range;
+    for (float& H : Heights) { H = (H - MinH) * InvRange; }
+
+    // Talus slope (rise per cell) in the same normalized units
+    const float Spacing = FMath::Max(GridSpacing, 1.f);
+    const float Talus = FMath::Tan(FMath::DegreesToRadians(FMath::Clamp(Settings.TalusAngleDeg, 1.f, 89.f))) * Spacing * InvRange;
+    const float Rate = FMath::Clamp(Settings.ThermalRate, 0.f, 0.5f);
+
+    if (Settings.ThermalStepsPerIteration > 0)
+    {
+        Scratch.Thermal.SetNumUninitialized(Heights.Num(), EAllowShrinking::No);
+        Scratch.Scale.SetNumUninitialized(Heights.Num(), EAllowShrinking::No);
+    }
+
+    for (int32 Pass = 0; Pass < Settings.Iterations; ++Pass)
+    {
+        if (Settings.DropletsPerCell > 0.f)
+        {
+            HydraulicPass(Heights.GetData(), VertsX, VertsY, Seed, Pass, Settings);
+        }
+
+        for (int32 Step = 0; Step < Settings.ThermalStepsPerIteration; ++Step)
+        {
+            ThermalStep(Heights.GetData(), Scratch.Thermal.GetData(), Scratch.Scale.GetData(), VertsX, VertsY, Talus, Rate);
+            Swap(Heights, Scratch.Thermal); // latest result always lives in Heights
+        }
+    }
+
+    for (float& H : Heights) { H = H * Range + MinH; }
+}
+
+void FTerrainErosion::HydraulicPass(float* H, int32 VertsX, int32 VertsY, int32 Seed, int32 Pass,
+    const FTerrainErosionSettings& S)
+{
+    const int32 Radius = FMath::Clamp(S.BrushRadius, 1, 6);
+    const FErosionBrush Brush = MakeBrush(Radius);
+
+    // Shift the tile lattice by half a tile on odd passes so tile borders never persist
+    const int32 Shift = (Pass & 1) ? ErosionTileSize / 2 : 0;
+    const int32 TilesX = (VertsX + Shift + ErosionTileSize - 1) / ErosionTileSize;
+    const int32 TilesY = (VertsY + Shift + ErosionTileSize - 1) / ErosionTileSize;
+
+    ParallelFor(TilesX * TilesY, [&](int32 TileIndex)
+    {
+        const int32 TX = TileIndex % TilesX;
+        const int32 TY = TileIndex / TilesX;
+
+        const int32 MinX = FMath::Max(0, TX * ErosionTileSize - Shift);
+        const int32 MinY = FMath::Max(0, TY * ErosionTileSize - Shift);
+        const int32 MaxX = FMath::Min(VertsX, (TX + 1) * ErosionTileSize - Shift);
+        const int32 MaxY = FMath::Min(VertsY, (TY + 1) * ErosionTileSize - Shift);
+
+        // Droplets (and their brush) stay inside the tile, so concurrent tiles never share cells
+        const float LoX = (float)(MinX + Radius);
+        const float LoY = (float)(MinY + Radius);
+        const float HiX = (float)(MaxX - Radius - 1);
+        const float HiY = (float)(MaxY - Radius - 1);
+        if (HiX - LoX < 1.f || HiY - LoY < 1.f) return;
+
+        const int32 NumDroplets = FMath::RoundToInt(S.DropletsPerCell * (MaxX - MinX) * (MaxY - MinY));
+        FRandomStream RNG((int32)HashCombine(HashCombine(GetTypeHash(Seed), GetTypeHash(Pass)), GetTypeHash(TileIndex)));
+
+        for (int32 d = 0; d < NumDroplets; ++d)
+        {
+            float PosX = RNG.FRandRange(LoX, HiX);
+            float PosY = RNG.FRandRange(LoY, HiY);
+            float DirX = 0.f, DirY = 0.f;
+            float Speed = 1.f, Water = 1.f, Sediment = 0.f;
+            int32 Node = 0;
+            float U = 0.f, V = 0.f;
+
+            for (int32 Life = 0; Life < S.DropletLifetime; ++Life)
+            {
+                const int32 NodeX = (int32)PosX;
+                const int32 NodeY = (int32)PosY;
+                Node = NodeY * VertsX + NodeX;
+                U = PosX - NodeX;
+                V = PosY - NodeY;
+
+                float Height, GX, GY;
+                HeightAndGradient(H, VertsX, PosX, PosY, Height, GX, GY);
+
+                DirX = DirX * S.Inertia - GX * (1.f - S.Inertia);
+                DirY = DirY * S.Inertia - GY * (1.f - S.Inertia);
+                const float Len = FMath::Sqrt(DirX * DirX + DirY * DirY);
+                if (Len < KINDA_SMALL_NUMBER) break; // flat: nowhere to flow
+                DirX /= Len;
+                DirY /= Len;
+
+                PosX += DirX;
+                PosY += DirY;
+                if (PosX < LoX || PosX >= HiX || PosY < LoY || PosY >= HiY) break;
+
+                float NewHeight, UnusedGX, UnusedGY;
+                HeightAndGradient(H, VertsX, PosX, PosY, NewHeight, UnusedGX, UnusedGY);
+                const float DeltaH = NewHeight - Height;
+
+                const float Capacity = FMath::Max(-DeltaH * Speed * Water * S.SedimentCapacity, S.MinSedimentCapacity);
+
+                if (Sediment > Capacity || DeltaH > 0.f)
+                {
+                    // Uphill: fill the pit behind us; otherwise drop the surplus
+                    const float Deposit = (DeltaH > 0.f) ? FMath::Min(DeltaH, Sediment) : (Sediment - Capacity) * S.DepositSpeed;
+                    Sediment -= Deposit;
+
+                    H[Node] += Deposit * (1.f - U) * (1.f - V);
+                    H[Node + 1] += Deposit * U * (1.f - V);
+                    H[Node + VertsX] += Deposit * (1.f - U) * V;
+                    H[Node + VertsX + 1] += Deposit * U * V;
+                }
+                else
+                {
+                    // Never dig deeper than the drop we just made, and never below where the
+                    // droplet is heading (the brush covers that cell too; digging it would feed back)
+                    const float Erode = FMath::Min((Capacity - Sediment) * S.ErodeSpeed, -DeltaH);
+                    for (int32 k = 0; k < Brush.Offsets.Num(); ++k)
+                    {
+                        const FIntPoint& O = Brush.Offsets[k];
+                        float& Cell = H[(NodeY + O.Y) * VertsX + NodeX + O.X];
+                        const float Removed = FMath::Min(Erode * Brush.Weights[k], FMath::Max(0.f, Cell - NewHeight));
+                        Cell -= Removed;
+                        Sediment += Removed;
+                    }
+                }
+
+                Speed = FMath::Sqrt(FMath::Max(0.f, Speed * Speed - DeltaH * S.Gravity));
+                Water *= (1.f - S.EvaporateSpeed);
+            }
+
+            // Whatever the droplet still carries settles where it stopped (keeps mass roughly conserved)
+            H[Node] += Sediment * (1.f - U) * (1.f - V);
+            H[Node + 1] += Sediment * U * (1.f - V);
+            H[Node + VertsX] += Sediment * (1.f - U) * V;
+            H[Node + VertsX + 1] += Sediment * U * V;
+        }
+    });
+}
+
+void FTerrainErosion::ThermalStep(const float* Src, float* Dst, float* Scale, int32 VertsX, int32 VertsY,
+    float Talus, float Rate)
+{
+    const int32 NumBlocks = (VertsY + ThermalRowsPerBlock - 1) / ThermalRowsPerBlock;
+
+    // Sum of (drop - talus) over the 4-neighbourhood; only neighbours steeper than talus receive material
+    auto ExcessSum = [Src, VertsX, VertsY, Talus](int32 x, int32 y, float& OutMaxDrop)
+    {
+        const float Hc = Src[y * VertsX + x];
+        float Sum = 0.f;
+        OutMaxDrop = 0.f;
+        auto Visit = [&](int32 nx, int32 ny)
+        {
+            if (nx < 0 || ny < 0 || nx >= VertsX || ny >= VertsY) return;
+            const float Drop = Hc - Src[ny * VertsX + nx];
+            if (Drop > Talus) Sum += Drop - Talus;
+            OutMaxDrop = FMath::Max(OutMaxDrop, Drop);
+        };
+        Visit(x - 1, y); Visit(x + 1, y); Visit(x, y - 1); Visit(x, y + 1);
+        return Sum;
+    };
+
+    // Pass 1: how much each cell sheds, expressed as a per-unit-excess factor
+    ParallelFor(NumBlocks, [&](int32 Block)
+    {
+        const int32 Y0 = Block * ThermalRowsPerBlock;
+        const int32 Y1 = FMath::Min(VertsY, Y0 + ThermalRowsPerBlock);
+        for (int32 y = Y0; y < Y1; ++y)
+        {
+            for (int32 x = 0; x < VertsX; ++x)
+            {
+                float MaxDrop;
+                const float Sum = ExcessSum(x, y, MaxDrop);
+                Scale[y * VertsX + x] = (Sum > 0.f) ? Rate * (MaxDrop - Talus) / Sum : 0.f;
+            }
+        }
+    });
+
+    // Pass 2: gather (own outflow + neighbours' inflow), so no two threads write the same cell
+    ParallelFor(NumBlocks, [&](int32 Block)
+    {
+        const int32 Y0 = Block * ThermalRowsPerBlock;
+        const int32 Y1 = FMath::Min(VertsY, Y0 + ThermalRowsPerBlock);
+        for (int32 y = Y0; y < Y1; ++y)
+        {
+            for (int32 x = 0; x < VertsX; ++x)
+            {
+                const int32 i = y * VertsX + x;
+                const float Hc = Src[i];
+
+                float MaxDrop;
+                float Result = Hc - Scale[i] * ExcessSum(x, y, MaxDrop);
+
+                auto Gather = [&](int32 nx, int32 ny)
+                {
+                    if (nx < 0 || ny < 0 || nx >= VertsX || ny >= VertsY) return;
+                    const int32 j = ny * VertsX + nx;
+                    const float Drop = Src[j] - Hc;
+                    if (Drop > Talus) Result += Scale[j] * (Drop - Talus);
+                };
+                Gather(x - 1, y); Gather(x + 1, y); Gather(x, y - 1); Gather(x, y + 1);
+
+                Dst[i] = Result;
+            }
+        }
+    });
+}
@@ -0,0 +1,263 @@
+#include "TerrainFootprintTables.h"
+#include "Async/ParallelFor.h"
+
+void FTerrainFootprintTables::Reset()
+{
+    VertsX = VertsY = 0;
+    SumH.Reset();
+    SumH2.Reset();
+    SumSlope.Reset();
+    MinLevels.Reset();
+    MaxLevels.Reset();
+}
+
+void FTerrainFootprintTables::Build(const TArray<float>& Heights, int32 InVertsX, int32 InVertsY, const TArray<FVector>* Normals)
+{
+    if (InVertsX < 1 || InVertsY < 1 || Heights.Num() != InVertsX * InVertsY)
+    {
+        Reset();
+        return;
+    }
+
+    // Every table is overwritten in place, so a rebuild at the same size doesn't allocate
+    VertsX = InVertsX;
+    VertsY = InVertsY;
+    SumSlope.Reset();
+
+    BuildTable(SumH, [&Heights](int32 i) { return (double)Heights[i]; });
+    BuildTable(SumH2, [&Heights](int32 i) { return (double)Heights[i] * (double)Heights[i]; });
+
+    if (Normals && Normals->Num() == Heights.Num())
+    {
+        BuildTable(SumSlope, [Normals](int32 i) { return GradientOf((*Normals)[i]); });
+    }
+
+    BuildPyramid(Heights);
+}
+
+void FTerrainFootprintTables::BuildTable(TArray<double>& Table, TFunctionRef<double(int32)> Value) const
+{
+    const int32 W = VertsX + 1;
+    Table.SetNumUninitialized(W * (VertsY + 1), EAllowShrinking::No);
+
+    // Zero border: first row and first column
+    FMemory::Memzero(Table.GetData(), W * sizeof(double));
+
+    for (int32 y = 0; y < VertsY; ++y)
+    {
+        double Row = 0.0;
+        const double* Above = Table.GetData() + y * W;
+        double* Out = Table.GetData() + (y + 1) * W;
+        Out[0] = 0.0;
+        for (int32 x = 0; x < VertsX; ++x)
+        {
+            Row += Value(y * VertsX + x);
+            Out[x + 1] = Above[x + 1] + Row;
+        }
+    }
+}
+
+void FTerrainFootprintTables::BuildPyramid(const TArray<float>& Heights)
+{
+    const int32 NumLevels = FMath::Min(MaxPyramidLevels, (int32)FMath::FloorLog2((uint32)FMath::Min(VertsX, VertsY)) + 1);
+
+    MinLevels.SetNum(NumLevels, EAllowShrinking::No);
+    MaxLevels.SetNum(NumLevels, EAllowShrinking::No);
+    for (int32 k = 0; k < NumLevels; ++k)
+    {
+        MinLevels[k].SetNumUninitialized(VertsX * VertsY, EAllowShrinking::No);
+        MaxLevels[k].SetNumUninitialized(VertsX * VertsY, EAllowShrinking::No);
+    }
+    FMemory::Memcpy(MinLevels[0].GetData(), Heights.GetData(), Heights.Num() * sizeof(float));
+    FMemory::Memcpy(MaxLevels[0].GetData(), Heights.GetData(), Heights.Num() * sizeof(float));
+
+    for (int32 k = 1; k < NumLevels; ++k)
+    {
+        ReduceLevel(k, 0, 0, VertsX, VertsY);
+    }
+}
+
+void FTerrainFootprintTables::ReduceLevel(int32 k, int32 CX0, int32 CY0, int32 CX1, int32 CY1)
+{
+    const int32 Half = 1 << (k - 1);
+    const int32 Size = 1 << k;
+    const TArray<float>& PrevMin = MinLevels[k - 1];
+    const TArray<float>& PrevMax = MaxLevels[k - 1];
+    TArray<float>& CurMin = MinLevels[k];
+    TArray<float>& CurMax = MaxLevels[k];
+
+    // Only corners whose square fits the grid are valid
+    CX0 = FMath::Max(CX0, 0);
+    CY0 = FMath::Max(CY0, 0);
+    CX1 = FMath::Min(CX1, VertsX - Size);
+    CY1 = FMath::Min(CY1, VertsY - Size);
+    if (CX0 > CX1 || CY0 > CY1) return;
+
+    ParallelFor(CY1 - CY0 + 1, [&](int32 Row)
+    {
+        const int32 y = CY0 + Row;
+        for (int32 x = CX0; x <= CX1; ++x)
+        {
+            const int32 i00 = y * VertsX + x;
+            const int32 i10 = i00 + Half;
+            const int32 i01 = i00 + Half * VertsX;
+            const int32 i11 = i01 + Half;
+            CurMin[i00] = FMath::Min(FMath::Min(PrevMin[i00], PrevMin[i10]), FMath::Min(PrevMin[i01], PrevMin[i11]));
+            CurMax[i00] = FMath::Max(FMath::Max(PrevMax[i00], PrevMax[i10]), FMath::Max(PrevMax[i01], PrevMax[i11]));
+        }
+    });
+}
+
+void FTerrainFootprintTables::UpdateRect(const TArray<float>& Heights, const FIntRect& Rect, const TArray<FVector>* RectNormals)
+{
+    if (!IsValid() || Heights.Num() != VertsX * VertsY) return;
+
+    const int32 X0 = Rect.Min.X, Y0 = Rect.Min.Y, X1 = Rect.Max.X, Y1 = Rect.Max.Y;
+    if (X0 < 0 || Y0 < 0 || X1 >= VertsX || Y1 >= VertsY || X0 > X1 || Y0 > Y1) return;
+
+    const int32 RectW = X1 - X0 + 1;
+
+    // Level 0 still holds the old heights, and each sum table its old per-vertex values, until
+    // they are overwritten below
+    const TArray<float>& OldHeights = MinLevels[0];
+    ApplyDelta(SumH, X0, Y0, X1, Y1, [&](int32 x, int32 y)
+    {
+        const int32 i = y * VertsX + x;
+        return (double)Heights[i] - (double)OldHeights[i];
+    });
+    ApplyDelta(SumH2, X0, Y0, X1, Y1, [&](int32 x, int32 y)
+    {
+        const int32 i = y * VertsX + x;
+        return (double)Heights[i] * (double)Heights[i] - (double)OldHeights[i] * (double)OldHeights[i];
+    });
+    if (HasSlope() && RectNormals && RectNormals->Num() == RectW * (Y1 - Y0 + 1))
+    {
+        ApplyDelta(SumSlope, X0, Y0, X1, Y1, [&](int32 x, int32 y)
+        {
+            return GradientOf((*RectNormals)[(y - Y0) * RectW + (x - X0)]) - RectSum(SumSlope, x, y, x, y);
+        });
+    }
+
+    for (int32 y = Y0; y <= Y1; ++y)
+    {
+        FMemory::Memcpy(&MinLevels[0][y * VertsX + X0], &Heights[y * VertsX + X0], RectW * sizeof(float));
+        FMemory::Memcpy(&MaxLevels[0][y * VertsX + X0], &Heights[y * VertsX + X0], RectW * sizeof(float));
+    }
+
+    // Level k squares reach 2^k - 1 vertices right/down of their corner
+    for (int32 k = 1; k < MinLevels.Num(); ++k)
+    {
+        const int32 Reach = (1 << k) - 1;
+        ReduceLevel(k, X0 - Reach, Y0 - Reach, X1, Y1);
+    }
+}
+
+void FTerrainFootprintTables::ApplyDelta(TArray<double>& Table, int32 X0, int32 Y0, int32 X1, int32 Y1,
+    TFunctionRef<double(int32 X, int32 Y)> Change)
+{
+    // Summed change over [X0, x) x [Y0, y), same layout as the tables (zero first row and column)
+    const int32 RectW = X1 - X0 + 1;
+    const int32 RectH = Y1 - Y0 + 1;
+    const int32 DW = RectW + 1;
+    TArray<double>& Delta = DeltaScratch;
+    Delta.SetNumUninitialized(DW * (RectH + 1), EAllowShrinking::No);
+    FMemory::Memzero(Delta.GetData(), DW * sizeof(double));
+    for (int32 ry = 0; ry < RectH; ++ry)
+    {
+        double Row = 0.0;
+        Delta[(ry + 1) * DW] = 0.0;
+        for (int32 rx = 0; rx < RectW; ++rx)
+        {
+            Row += Change(X0 + rx, Y0 + ry);
+            Delta[(ry + 1) * DW + rx + 1] = Delta[ry * DW + rx + 1] + Row;
+        }
+    }
+
+    // Every entry below and right of the rect's corner gains the change it now encloses
+    const int32 W = VertsX + 1;
+    ParallelFor(VertsY - Y0, [&](int32 Row)
+    {
+        const int32 ty = Y0 + 1 + Row;
+        const double* DeltaRow = Delta.GetData() + FMath::Min(ty - Y0, RectH) * DW;
+        double* Out = Table.GetData() + ty * W;
+        for (int32 tx = X0 + 1; tx <= VertsX; ++tx)
+        {
+            Out[tx] += DeltaRow[FMath::Min(tx - X0, RectW)];
+        }
+    });
+}
+
+double FTerrainFootprintTables::RectSum(const TArray<double>& Table, int32 X0, int32 Y0, int32 X1, int32 Y1) const
+{
+    const int32 W = VertsX + 1;
+    return Table[(Y1 + 1) * W + (X1 + 1)] - Table[Y0 * W + (X1 + 1)]
+         - Table[(Y1 + 1) * W + X0] + Table[Y0 * W + X0];
+}
+
+void FTerrainFootprintTables::RectMinMax(int32 X0, int32 Y0, int32 X1, int32 Y1, float& OutMin, float& OutMax) const
+{
+    const int32 W = X1 - X0 + 1;
+    const int32 H = Y1 - Y0 + 1;
+    const int32 k = FMath::Min((int32)FMath::FloorLog2((uint32)FMath::Min(W, H)), MinLevels.Num() - 1);
+    const int32 S = 1 << k;
+    const TArray<float>& LevelMin = MinLevels[k];
+    const TArray<float>& LevelMax = MaxLevels[k];
+
+    OutMin = TNumericLimits<float>::Max();
+    OutMax = TNumericLimits<float>::Lowest();
+
+    // Overlapping S-squares cover the rectangle; the last one in each axis is pulled back inside
+    for (int32 y = Y0; ; y += S)
+    {
+        const int32 SY = FMath::Min(y, Y1 - S + 1);
+        for (int32 x = X0; ; x += S)
+        {
+            const int32 i = SY * VertsX + FMath::Min(x, X1 - S + 1);
+            OutMin = FMath::Min(OutMin, LevelMin[i]);
+            OutMax = FMath::Max(OutMax, LevelMax[i]);
+            if (x + S > X1) break;
+        }
+        if (y + S > Y1) break;
+    }
+}
+
+FTerrainFootprintStats FTerrainFootprintTables::Query(int32 X0, int32 Y0, int32 X1, int32 Y1) const
+{
+    FTerrainFootprintStats Stats;
+    if (!IsValid()) return Stats;
+
+    if (X0 > X1) Swap(X0, X1);
+    if (Y0 > Y1) Swap(Y0, Y1);
+    if (X1 < 0 || Y1 < 0 || X0 >= VertsX || Y0 >= VertsY) return Stats;
+
+    X0 = FMath::Max(X0, 0);
+    Y0 = FMath::Max(Y0, 0);
+    X1 = FMath::Min(X1, VertsX - 1);
+    Y1 = FMath::Min(Y1, VertsY - 1);
+
+    const int32 N = (X1 - X0 + 1) * (Y1 - Y0 + 1);
+    const double Mean = RectSum(SumH, X0, Y0, X1, Y1) / N;
+    const double MeanSq = RectSum(SumH2, X0, Y0, X1, Y1) / N;
+
+    Stats.bValid = true;
+    Stats.NumSamples = N;
+    Stats.MeanHeight = (float)Mean;
+    Stats.HeightVariance = (float)FMath::Max(MeanSq - Mean * Mean, 0.0);
+    RectMinMax(X0, Y0, X1, Y1, Stats.MinHeight, Stats.MaxHeight);
+
+    if (HasSlope())
+    {
+        const double MeanGradient = RectSum(SumSlope, X0, Y0, X1, Y1) / N;
+        Stats.MeanSlopeDeg = FMath::RadiansToDegrees((float)FMath::Atan(MeanGradient));
+    }
+
+    return Stats;
+}
+
+SIZE_T FTerrainFootprintTables::GetAllocatedSize() const
+{
+    SIZE_T Bytes = SumH.GetAllocatedSize() + SumH2.GetAllocatedSize() + SumSlope.GetAllocatedSize();
+    for (const TArray<float>& Level : MinLevels) Bytes += Level.GetAllocatedSize();
+    for (const TArray<float>& Level : MaxLevels) Bytes += Level.GetAllocatedSize();
+    return Bytes + DeltaScratch.GetAllocatedSize();
+}
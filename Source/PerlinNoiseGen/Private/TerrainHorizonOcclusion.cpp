@@ -0,0 +1,171 @@
+#include "TerrainHorizonOcclusion.h"
+#include "Async/ParallelFor.h"
+
+void FTerrainHorizonOcclusion::Reset()
+{
+    Ground.Reset();
+    TilesX = TilesY = 0;
+    TileMinZ.Reset();
+    TileMaxZ.Reset();
+    TileHorizon.Reset();
+}
+
+void FTerrainHorizonOcclusion::BuildTiles(const FTerrainSnapshotRef& InGround, int32 InTileQuads)
+{
+    if (!InGround->IsValid())
+    {
+        Reset();
+        return;
+    }
+
+    Ground = InGround;
+    const FTerrainSnapshot& G = *InGround;
+    const int32 TileQuads = FMath::Max(InTileQuads, 1);
+    const int32 VertsX = G.NumQuadsX + 1;
+
+    TilesX = FMath::DivideAndRoundUp(G.NumQuadsX, TileQuads);
+    TilesY = FMath::DivideAndRoundUp(G.NumQuadsY, TileQuads);
+    TileExtent = TileQuads * G.GridSpacing;
+    Origin = FVector2f(-G.NumQuadsX * G.GridSpacing * 0.5f, -G.NumQuadsY * G.GridSpacing * 0.5f);
+
+    const int32 NumTiles = TilesX * TilesY;
+    TileMinZ.SetNumUninitialized(NumTiles, EAllowShrinking::No);
+    TileMaxZ.SetNumUninitialized(NumTiles, EAllowShrinking::No);
+    TileHorizon.SetNumUninitialized(NumTiles, EAllowShrinking::No);
+
+    // Inclusive vertex ranges, so the tiles' shared edges count for both
+    ParallelFor(NumTiles, [&](int32 Tile)
+    {
+        const int32 X0 = (Tile % TilesX) * TileQuads;
+        const int32 Y0 = (Tile / TilesX) * TileQuads;
+        const int32 X1 = FMath::Min(X0 + TileQuads, G.NumQuadsX);
+        const int32 Y1 = FMath::Min(Y0 + TileQuads, G.NumQuadsY);
+
+        float MinZ = FLT_MAX, MaxZ = -FLT_MAX;
+        for (int32 y = Y0; y <= Y1; ++y)
+        {
+            const float* Row = G.Heights.GetData() + y * VertsX;
+            for (int32 x = X0; x <= X1; ++x)
+            {
+                MinZ = FMath::Min(MinZ, Row[x]);
+                MaxZ = FMath::Max(MaxZ, Row[x]);
+            }
+        }
+        TileMinZ[Tile] = MinZ;
+        TileMaxZ[Tile] = MaxZ;
+        TileHorizon[Tile] = -FLT_MAX;
+    });
+}
+
+void FTerrainHorizonOcclusion::Update(const FVector& LocalEye, int32 NumBins)
+{
+    if (!IsValid()) return;
+
+    Eye = LocalEye;
+    NumBins = FMath::Clamp(NumBins, 16, 8192);
+    const float BinSize = 2.f * PI / NumBins;
+    const FVector2f E((float)Eye.X, (float)Eye.Y);
+    const float EyeZ = (float)Eye.Z;
+    const int32 NumTiles = TileMinZ.Num();
+
+    Horizon.SetNumUninitialized(NumBins, EAllowShrinking::No);
+    for (float& H : Horizon) H = -FLT_MAX;
+
+    // --- Front to back: nearest point of each tile to the eye ---
+    TileNearDist.SetNumUninitialized(NumTiles, EAllowShrinking::No);
+    TileOrder.SetNumUninitialized(NumTiles, EAllowShrinking::No);
+    for (int32 Tile = 0; Tile < NumTiles; ++Tile)
+    {
+        const FVector2f Min = Origin + FVector2f((Tile % TilesX) * TileExtent, (Tile / TilesX) * TileExtent);
+        const float DX = FMath::Max3(Min.X - E.X, 0.f, E.X - (Min.X + TileExtent));
+        const float DY = FMath::Max3(Min.Y - E.Y, 0.f, E.Y - (Min.Y + TileExtent));
+        TileNearDist[Tile] = FMath::Sqrt(DX * DX + DY * DY);
+        TileOrder[Tile] = Tile;
+    }
+    TileOrder.Sort([this](int32 A, int32 B) { return TileNearDist[A] < TileNearDist[B]; });
+
+    // Occluders join the horizon only once the sweep is past their far edge, so a tile is never
+    // tested against terrain that isn't entirely in front of it
+    Pending.Reset();
+    auto ByFarDist = [](const FOccluder& A, const FOccluder& B) { return A.FarDist < B.FarDist; };
+
+    for (const int32 Tile : TileOrder)
+    {
+        const float NearDist = TileNearDist[Tile];
+
+        while (Pending.Num() > 0 && Pending.HeapTop().FarDist <= NearDist)
+        {
+            FOccluder O;
+            Pending.HeapPop(O, ByFarDist, EAllowShrinking::No);
+            for (int32 k = 0; k < O.NumBins; ++k)
+            {
+                float& H = Horizon[(O.FirstBin + k) % NumBins];
+                H = FMath::Max(H, O.Slope);
+            }
+        }
+
+        // The eye's own tile (and any it touches) sees everything and blocks nothing
+        if (NearDist < MinOccludeeDistance)
+        {
+            TileHorizon[Tile] = -FLT_MAX;
+            continue;
+        }
+
+        // Azimuth span of the tile's corners around the direction to its center; under PI since the
+        // eye is outside the tile
+        const FVector2f Min = Origin + FVector2f((Tile % TilesX) * TileExtent, (Tile / TilesX) * TileExtent);
+        const FVector2f Center = Min + FVector2f(0.5f * TileExtent, 0.5f * TileExtent);
+        const float CenterAngle = FMath::Atan2(Center.Y - E.Y, Center.X - E.X);
+        float Lo = 0.f, Hi = 0.f, FarDist = 0.f;
+        for (int32 c = 0; c < 4; ++c)
+        {
+            const FVector2f P = Min + FVector2f((c & 1) ? TileExtent : 0.f, (c & 2) ? TileExtent : 0.f);
+            const float Rel = FMath::UnwindRadians(FMath::Atan2(P.Y - E.Y, P.X - E.X) - CenterAngle);
+            Lo = FMath::Min(Lo, Rel);
+            Hi = FMath::Max(Hi, Rel);
+            FarDist = FMath::Max(FarDist, FVector2f::Distance(P, E));
+        }
+        Lo += CenterAngle;
+        Hi += CenterAngle;
+
+        // Test: the lowest horizon over every bin the tile touches
+        const int32 FirstTouched = FMath::FloorToInt(Lo / BinSize);
+        const int32 LastTouched = FMath::FloorToInt(Hi / BinSize);
+        float Lowest = FLT_MAX;
+        for (int32 b = FirstTouched; b <= LastTouched; ++b)
+        {
+            Lowest = FMath::Min(Lowest, Horizon[((b % NumBins) + NumBins) % NumBins]);
+        }
+        TileHorizon[Tile] = Lowest;
+
+        // Occluder: the tile's floor blocks whatever is below it in the bins it fully covers. Rising
+        // floors are measured at the far corner, sinking ones at the near edge: both the shallowest case
+        const int32 FirstCovered = FMath::CeilToInt(Lo / BinSize);
+        const int32 LastCovered = FMath::FloorToInt(Hi / BinSize) - 1;
+        if (LastCovered >= FirstCovered)
+        {
+            const float Rise = TileMinZ[Tile] - EyeZ;
+            FOccluder O;
+            O.FarDist = FarDist;
+            O.Slope = Rise / (Rise >= 0.f ? FarDist : NearDist);
+            O.FirstBin = ((FirstCovered % NumBins) + NumBins) % NumBins;
+            O.NumBins = LastCovered - FirstCovered + 1;
+            Pending.HeapPush(O, ByFarDist);
+        }
+    }
+}
+
+float FTerrainHorizonOcclusion::GetOccludedTileFraction(float HeightAboveGround) const
+{
+    if (!IsValid()) return 0.f;
+
+    int32 Occluded = 0;
+    for (int32 Tile = 0; Tile < TileMinZ.Num(); ++Tile)
+    {
+        // The tile's nearest point is the hardest to hide; judge the tile by its center at its highest
+        const float CX = Origin.X + ((Tile % TilesX) + 0.5f) * TileExtent;
+        const float CY = Origin.Y + ((Tile / TilesX) + 0.5f) * TileExtent;
+        if (IsPointOccluded(CX, CY, TileMaxZ[Tile] + HeightAboveGround)) ++Occluded;
+    }
+    return (float)Occluded / (float)TileMinZ.Num();
+}
@@ -0,0 +1,475 @@
+#include "TerrainMeshComponent.h"
+#include "Engine/Engine.h"
+#include "LocalVertexFactory.h"
+#include "MaterialDomain.h"
+#include "Materials/Material.h"
+#include "Materials/MaterialRenderProxy.h"
+#include "PrimitiveSceneProxy.h"
+#include "PrimitiveViewRelevance.h"
+#include "RawIndexBuffer.h"
+#include "SceneInterface.h"
+#include "SceneManagement.h"
+#include "StaticMeshResources.h"
+
+namespace
+{
+    // A stripe row touches StripeQuads + 1 new vertices, so the previous row is still in the
+    // post-transform cache and each vertex is shaded about once
+    constexpr int32 IndexStripeQuads = 16;
+
+    void AppendTileIndices(TArray<uint32>& Out, int32 QuadsX, int32 QuadsY)
+    {
+        const int32 RowVerts = QuadsX + 1;
+        for (int32 S0 = 0; S0 < QuadsX; S0 += IndexStripeQuads)
+        {
+            const int32 S1 = FMath::Min(S0 + IndexStripeQuads, QuadsX);
+            for (int32 y = 0; y < QuadsY; ++y)
+            {
+                for (int32 x = S0; x < S1; ++x)
+                {
+                    const uint32 v00 = y * RowVerts + x;
+                    const uint32 v10 = v00 + 1;
+                    const uint32 v01 = v00 + RowVerts;
+                    const uint32 v11 = v01 + 1;
+
+                    // Same winding as the ProcMesh grid (+Z)
+                    Out.Add(v00); Out.Add(v11); Out.Add(v10);
+                    Out.Add(v00); Out.Add(v01); Out.Add(v11);
+                }
+            }
+        }
+    }
+
+    // Tangent = +X projected onto the surface (what the old constant +X tangent meant)
+    FVector3f TangentXFromNormal(const FVector3f& N)
+    {
+        return (FVector3f(1.f, 0.f, 0.f) - N * N.X).GetSafeNormal();
+    }
+
+    void WriteBufferRange(FRHICommandListBase& RHICmdList, FBufferRHIRef& Buffer, uint32 Offset, const void* Src, uint32 Size)
+    {
+        void* Dst = RHICmdList.LockBuffer(Buffer, Offset, Size, RLM_WriteOnly);
+        FMemory::Memcpy(Dst, Src, Size);
+        RHICmdList.UnlockBuffer(Buffer);
+    }
+}
+
+/** New vertex data for one tile, in the tile's vertex order. */
+struct FTerrainMeshTileUpdate
+{
+    int32 TileIndex = INDEX_NONE;
+    TArray<FVector3f> Positions;
+    TArray<FPackedNormal> Tangents;   // TangentX, TangentZ per vertex (low-precision layout)
+    TArray<FColor> Colors;            // empty if the mesh has none
+};
+
+// ---- FTerrainMeshData ----
+
+FIntRect FTerrainMeshData::GetTileVertexRect(int32 TileIndex) const
+{
+    const int32 TQ = GetTileQuads();
+    const int32 X0 = (TileIndex % GetTilesX()) * TQ;
+    const int32 Y0 = (TileIndex / GetTilesX()) * TQ;
+    return FIntRect(X0, Y0, FMath::Min(X0 + TQ, NumQuadsX), FMath::Min(Y0 + TQ, NumQuadsY));
+}
+
+FVector3f FTerrainMeshData::GetLocalPosition(int32 X, int32 Y) const
+{
+    // Centered like ANoiseTerrainActor's grid
+    return FVector3f(
+        X * GridSpacing - NumQuadsX * GridSpacing * 0.5f,
+        Y * GridSpacing - NumQuadsY * GridSpacing * 0.5f,
+        Heights[Y * GetVertsX() + X]);
+}
+
+FVector2f FTerrainMeshData::GetUV(int32 X, int32 Y) const
+{
+    return FVector2f((float)X / (float)NumQuadsX, (float)Y / (float)NumQuadsY);
+}
+
+void FTerrainMeshData::RecomputeBounds()
+{
+    LocalBounds.Init();
+    if (!IsValid()) return;
+
+    float MinZ = Heights[0], MaxZ = Heights[0];
+    for (const float H : Heights)
+    {
+        MinZ = FMath::Min(MinZ, H);
+        MaxZ = FMath::Max(MaxZ, H);
+    }
+
+    const float HalfW = NumQuadsX * GridSpacing * 0.5f;
+    const float HalfH = NumQuadsY * GridSpacing * 0.5f;
+    LocalBounds = FBox(FVector(-HalfW, -HalfH, MinZ), FVector(HalfW, HalfH, MaxZ));
+}
+
+void FTerrainMeshData::BuildLayout(TArray<FTerrainMeshTile>& OutTiles, TArray<uint32>& OutIndices, int32& OutNumVertices) const
+{
+    OutTiles.Reset();
+    OutIndices.Reset();
+    OutNumVertices = 0;
+    if (!IsValid()) return;
+
+    const int32 TQ = GetTileQuads();
+    const int32 TilesX = GetTilesX();
+    const int32 TilesY = GetTilesY();
+    OutTiles.Reserve(TilesX * TilesY);
+
+    // Index patterns by tile size (interior / right edge / bottom edge / corner)
+    TMap<FIntPoint, int32> PatternFirstIndex;
+
+    for (int32 ty = 0; ty < TilesY; ++ty)
+    {
+        for (int32 tx = 0; tx < TilesX; ++tx)
+        {
+            FTerrainMeshTile& Tile = OutTiles.AddDefaulted_GetRef();
+            Tile.QuadX0 = tx * TQ;
+            Tile.QuadY0 = ty * TQ;
+            Tile.QuadsX = FMath::Min(TQ, NumQuadsX - Tile.QuadX0);
+            Tile.QuadsY = FMath::Min(TQ, NumQuadsY - Tile.QuadY0);
+            Tile.BaseVertex = OutNumVertices;
+            Tile.NumTriangles = Tile.QuadsX * Tile.QuadsY * 2;
+
+            const FIntPoint Size(Tile.QuadsX, Tile.QuadsY);
+            if (const int32* First = PatternFirstIndex.Find(Size))
+            {
+                Tile.FirstIndex = *First;
+            }
+            else
+            {
+                Tile.FirstIndex = OutIndices.Num();
+                PatternFirstIndex.Add(Size, Tile.FirstIndex);
+                AppendTileIndices(OutIndices, Tile.QuadsX, Tile.QuadsY);
+            }
+
+            OutNumVertices += Tile.NumVertices();
+        }
+    }
+}
+
+// ---- Scene proxy ----
+
+class FTerrainMeshSceneProxy final : public FPrimitiveSceneProxy
+{
+public:
+    SIZE_T GetTypeHash() const override
+    {
+        static size_t UniquePointer;
+        return reinterpret_cast<size_t>(&UniquePointer);
+    }
+
+    FTerrainMeshSceneProxy(UTerrainMeshComponent* Component)
+        : FPrimitiveSceneProxy(Component)
+        , VertexFactory(GetScene().GetFeatureLevel(), "FTerrainMeshSceneProxy")
+        , MaterialRelevance(Component->GetMaterialRelevance(GetScene().GetFeatureLevel()))
+    {
+        const FTerrainMeshData& Data = Component->GetMeshData();
+
+        TArray<uint32> Indices;
+        int32 NumVertices = 0;
+        Data.BuildLayout(Tiles, Indices, NumVertices);
+
+        // Compact stream: float3 position, packed 8-byte tangent frame, half UVs, optional color
+        VertexBuffers.PositionVertexBuffer.Init(NumVertices, /*bNeedsCPUAccess=*/false);
+        VertexBuffers.StaticMeshVertexBuffer.SetUseFullPrecisionUVs(false);
+        VertexBuffers.StaticMeshVertexBuffer.SetUseHighPrecisionTangentBasis(false);
+        VertexBuffers.StaticMeshVertexBuffer.Init(NumVertices, 1, /*bNeedsCPUAccess=*/false);
+
+        bHasColors = Data.Colors.Num() == Data.Heights.Num();
+        if (bHasColors)
+        {
+            VertexBuffers.ColorVertexBuffer.Init(NumVertices, /*bNeedsCPUAccess=*/false);
+        }
+
+        for (const FTerrainMeshTile& Tile : Tiles)
+        {
+            WriteTileVertices(Data, Tile);
+        }
+
+        IndexBuffer.SetIndices(Indices, EIndexBufferStride::Force16Bit);
+
+        Material = Component->GetMaterial(0);
+        if (!Material)
+        {
+            Material = UMaterial::GetDefaultMaterial(MD_Surface);
+        }
+
+        ENQUEUE_RENDER_COMMAND(InitTerrainMeshResources)(
+            [this](FRHICommandListImmediate& RHICmdList)
+            {
+                VertexBuffers.PositionVertexBuffer.InitResource(RHICmdList);
+                VertexBuffers.StaticMeshVertexBuffer.InitResource(RHICmdList);
+                VertexBuffers.ColorVertexBuffer.InitResource(RHICmdList);
+
+                FLocalVertexFactory::FDataType Data;
+                VertexBuffers.PositionVertexBuffer.BindPositionVertexBuffer(&VertexFactory, Data);
+                VertexBuffers.StaticMeshVertexBuffer.BindTangentVertexBuffer(&VertexFactory, Data);
+                VertexBuffers.StaticMeshVertexBuffer.BindPackedTexCoordVertexBuffer(&VertexFactory, Data);
+                VertexBuffers.StaticMeshVertexBuffer.BindLightMapVertexBuffer(&VertexFactory, Data, 0);
+                VertexBuffers.ColorVertexBuffer.BindColorVertexBuffer(&VertexFactory, Data);
+                VertexFactory.SetData(RHICmdList, Data);
+                VertexFactory.InitResource(RHICmdList);
+
+                IndexBuffer.InitResource(RHICmdList);
+            });
+    }
+
+    virtual ~FTerrainMeshSceneProxy()
+    {
+        VertexBuffers.PositionVertexBuffer.ReleaseResource();
+        VertexBuffers.StaticMeshVertexBuffer.ReleaseResource();
+        VertexBuffers.ColorVertexBuffer.ReleaseResource();
+        IndexBuffer.ReleaseResource();
+        VertexFactory.ReleaseResource();
+    }
+
+    virtual void DrawStaticElements(FStaticPrimitiveDrawInterface* PDI) override
+    {
+        const FMaterialRenderProxy* MaterialProxy = Material->GetRenderProxy();
+
+        // One batch per tile; each addresses its own vertex range with 16-bit indices
+        for (const FTerrainMeshTile& Tile : Tiles)
+        {
+            FMeshBatch Mesh;
+            FMeshBatchElement& BatchElement = Mesh.Elements[0];
+            BatchElement.IndexBuffer = &IndexBuffer;
+            BatchElement.FirstIndex = Tile.FirstIndex;
+            BatchElement.NumPrimitives = Tile.NumTriangles;
+            BatchElement.BaseVertexIndex = Tile.BaseVertex;
+            BatchElement.MinVertexIndex = 0;
+            BatchElement.MaxVertexIndex = Tile.NumVertices() - 1;
+
+            Mesh.VertexFactory = &VertexFactory;
+            Mesh.MaterialRenderProxy = MaterialProxy;
+            Mesh.ReverseCulling = IsLocalToWorldDeterminantNegative();
+            Mesh.Type = PT_TriangleList;
+            Mesh.DepthPriorityGroup = SDPG_World;
+            Mesh.LODIndex = 0;
+            Mesh.CastShadow = true;
+            Mesh.bCanApplyViewModeOverrides = false;
+
+            PDI->DrawMesh(Mesh, FLT_MAX);
+        }
+    }
+
+    virtual FPrimitiveViewRelevance GetViewRelevance(const FSceneView* View) const override
+    {
+        FPrimitiveViewRelevance Result;
+        Result.bDrawRelevance = IsShown(View);
+        Result.bShadowRelevance = IsShadowCast(View);
+        Result.bStaticRelevance = true;
+        Result.bRenderInMainPass = ShouldRenderInMainPass();
+        Result.bUsesLightingChannels = GetLightingChannelMask() != GetDefaultLightingChannelMask();
+        Result.bRenderCustomDepth = ShouldRenderCustomDepth();
+        MaterialRelevance.SetPrimitiveViewRelevance(Result);
+        Result.bVelocityRelevance = DrawsVelocity() && Result.bOpaque && Result.bRenderInMainPass;
+        return Result;
+    }
+
+    virtual bool CanBeOccluded() const override
+    {
+        return !MaterialRelevance.bDisableDepthTest;
+    }
+
+    // Tiles are rewritten in place with write-only locks; the layout never changes
+    void UpdateTiles_RenderThread(FRHICommandListBase& RHICmdList, const TArray<FTerrainMeshTileUpdate>& Updates)
+    {
+        for (const FTerrainMeshTileUpdate& Update : Updates)
+        {
+            if (!Tiles.IsValidIndex(Update.TileIndex)) continue;
+
+            const FTerrainMeshTile& Tile = Tiles[Update.TileIndex];
+            const uint32 NumVerts = Tile.NumVertices();
+            if (Update.Positions.Num() != NumVerts) continue;
+
+            WriteBufferRange(RHICmdList, VertexBuffers.PositionVertexBuffer.VertexBufferRHI,
+                Tile.BaseVertex * sizeof(FVector3f), Update.Positions.GetData(), NumVerts * sizeof(FVector3f));
+            WriteBufferRange(RHICmdList, VertexBuffers.StaticMeshVertexBuffer.TangentsVertexBuffer.VertexBufferRHI,
+                Tile.BaseVertex * 2 * sizeof(FPackedNormal), Update.Tangents.GetData(), NumVerts * 2 * sizeof(FPackedNormal));
+
+            if (bHasColors && Update.Colors.Num() == NumVerts)
+            {
+                WriteBufferRange(RHICmdList, VertexBuffers.ColorVertexBuffer.VertexBufferRHI,
+                    Tile.BaseVertex * sizeof(FColor), Update.Colors.GetData(), NumVerts * sizeof(FColor));
+            }
+        }
+    }
+
+    virtual uint32 GetMemoryFootprint() const override
+    {
+        return sizeof(*this) + GetAllocatedSize();
+    }
+
+    uint32 GetAllocatedSize() const
+    {
+        return FPrimitiveSceneProxy::GetAllocatedSize() + Tiles.GetAllocatedSize();
+    }
+
+private:
+    void WriteTileVertices(const FTerrainMeshData& Data, const FTerrainMeshTile& Tile)
+    {
+        const int32 VertsX = Data.GetVertsX();
+        int32 V = Tile.BaseVertex;
+
+        for (int32 y = Tile.QuadY0; y <= Tile.QuadY0 + Tile.QuadsY; ++y)
+        {
+            for (int32 x = Tile.QuadX0; x <= Tile.QuadX0 + Tile.QuadsX; ++x, ++V)
+            {
+                const int32 i = y * VertsX + x;
+
+                VertexBuffers.PositionVertexBuffer.VertexPosition(V) = Data.GetLocalPosition(x, y);
+
+                const FVector3f N = Data.Normals[i].ToFVector3f();
+                const FVector3f TX = TangentXFromNormal(N);
+                const FVector3f TY = FVector3f::CrossProduct(N, TX);
+                VertexBuffers.StaticMeshVertexBuffer.SetVertexTangents(V, TX, TY, N);
+                VertexBuffers.StaticMeshVertexBuffer.SetVertexUV(V, 0, Data.GetUV(x, y));
+
+                if (bHasColors)
+                {
+                    VertexBuffers.ColorVertexBuffer.VertexColor(V) = Data.Colors[i];
+                }
+            }
+        }
+    }
+
+    FStaticMeshVertexBuffers VertexBuffers;
+    FRawStaticIndexBuffer IndexBuffer;
+    FLocalVertexFactory VertexFactory;
+
+    TArray<FTerrainMeshTile> Tiles;
+    bool bHasColors = false;
+
+    UMaterialInterface* Material = nullptr;
+    FMaterialRelevance MaterialRelevance;
+};
+
+// ---- UTerrainMeshComponent ----
+
+UTerrainMeshComponent::UTerrainMeshComponent(const FObjectInitializer& ObjectInitializer)
+    : Super(ObjectInitializer)
+{
+    PrimaryComponentTick.bCanEverTick = false;
+
+    // Render only; collision comes from the ProcMesh / collision tiles
+    SetCollisionEnabled(ECollisionEnabled::NoCollision);
+}
+
+void UTerrainMeshComponent::SetMeshData(FTerrainMeshData&& InData)
+{
+    MeshData = MoveTemp(InData);
+    if (!MeshData.LocalBounds.IsValid)
+    {
+        MeshData.RecomputeBounds();
+    }
+
+    UpdateBounds();
+    MarkRenderStateDirty();
+}
+
+void UTerrainMeshComponent::SwapMeshData(FTerrainMeshData& InOutData)
+{
+    Swap(MeshData, InOutData);
+    if (!MeshData.LocalBounds.IsValid)
+    {
+        MeshData.RecomputeBounds();
+    }
+
+    UpdateBounds();
+    MarkRenderStateDirty();
+}
+
+void UTerrainMeshComponent::ClearMeshData()
+{
+    if (!MeshData.IsValid()) return;
+
+    MeshData = FTerrainMeshData();
+    UpdateBounds();
+    MarkRenderStateDirty();
+}
+
+void UTerrainMeshComponent::CommitTile(int32 TileIndex)
+{
+    if (!MeshData.IsValid() || TileIndex < 0 || TileIndex >= MeshData.GetTilesX() * MeshData.GetTilesY()) return;
+
+    const FIntRect Rect = MeshData.GetTileVertexRect(TileIndex);
+    const int32 VertsX = MeshData.GetVertsX();
+    const bool bHasColors = MeshData.Colors.Num() == MeshData.Heights.Num();
+
+    FTerrainMeshTileUpdate Update;
+    Update.TileIndex = TileIndex;
+    const int32 NumVerts = (Rect.Width() + 1) * (Rect.Height() + 1);
+    Update.Positions.Reserve(NumVerts);
+    Update.Tangents.Reserve(NumVerts * 2);
+    if (bHasColors) Update.Colors.Reserve(NumVerts);
+
+    float MinZ = MeshData.LocalBounds.Min.Z, MaxZ = MeshData.LocalBounds.Max.Z;
+    for (int32 y = Rect.Min.Y; y <= Rect.Max.Y; ++y)
+    {
+        for (int32 x = Rect.Min.X; x <= Rect.Max.X; ++x)
+        {
+            const int32 i = y * VertsX + x;
+            const FVector3f P = MeshData.GetLocalPosition(x, y);
+            Update.Positions.Add(P);
+            MinZ = FMath::Min(MinZ, P.Z);
+            MaxZ = FMath::Max(MaxZ, P.Z);
+
+            // Same basis SetVertexTangents builds on upload (determinant sign +1)
+            const FVector3f N = MeshData.Normals[i].ToFVector3f();
+            Update.Tangents.Add(FPackedNormal(TangentXFromNormal(N)));
+            Update.Tangents.Add(FPackedNormal(FVector4f(N, 1.f)));
+
+            if (bHasColors) Update.Colors.Add(MeshData.Colors[i]);
+        }
+    }
+
+    // Edits can only grow the bounds here; a full SetMeshData tightens them again
+    if (MinZ < MeshData.LocalBounds.Min.Z || MaxZ > MeshData.LocalBounds.Max.Z)
+    {
+        MeshData.LocalBounds.Min.Z = MinZ;
+        MeshData.LocalBounds.Max.Z = MaxZ;
+        UpdateBounds();
+        MarkRenderTransformDirty();
+    }
+
+    if (FTerrainMeshSceneProxy* Proxy = static_cast<FTerrainMeshSceneProxy*>(SceneProxy))
+    {
+        TArray<FTerrainMeshTileUpdate> Updates;
+        Updates.Add(MoveTemp(Update));
+        ENQUEUE_RENDER_COMMAND(UpdateTerrainMeshTile)(
+            [Proxy, Updates = MoveTemp(Updates)](FRHICommandListImmediate& RHICmdList)
+            {
+                Proxy->UpdateTiles_RenderThread(RHICmdList, Updates);
+            });
+    }
+}
+
+SIZE_T UTerrainMeshComponent::GetGPUMemoryBytes() const
+{
+    if (!MeshData.IsValid()) return 0;
+
+    TArray<FTerrainMeshTile> Tiles;
+    TArray<uint32> Indices;
+    int32 NumVertices = 0;
+    MeshData.BuildLayout(Tiles, Indices, NumVertices);
+
+    // float3 position + 2 packed normals + half2 UV (+ color)
+    const SIZE_T BytesPerVertex = sizeof(FVector3f) + 2 * sizeof(FPackedNormal) + sizeof(FVector2DHalf)
+        + (MeshData.Colors.Num() > 0 ? sizeof(FColor) : 0);
+    return NumVertices * BytesPerVertex + Indices.Num() * sizeof(uint16);
+}
+
+FPrimitiveSceneProxy* UTerrainMeshComponent::CreateSceneProxy()
+{
+    return MeshData.IsValid() ? new FTerrainMeshSceneProxy(this) : nullptr;
+}
+
+FBoxSphereBounds UTerrainMeshComponent::CalcBounds(const FTransform& LocalToWorld) const
+{
+    if (!MeshData.LocalBounds.IsValid)
+    {
+        return FBoxSphereBounds(LocalToWorld.GetLocation(), FVector::ZeroVector, 0.f);
+    }
+    return FBoxSphereBounds(MeshData.LocalBounds).TransformBy(LocalToWorld);
+}
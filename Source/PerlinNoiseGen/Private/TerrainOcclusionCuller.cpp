@@ -0,0 +1,143 @@
+#include "TerrainOcclusionCuller.h"
+#include "NoiseTerrainActor.h"
+#include "ScatterSpawner.h"
+#include "HordeCrowd.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+#include "Camera/PlayerCameraManager.h"
+
+ATerrainOcclusionCuller::ATerrainOcclusionCuller()
+    : Occlusion(MakeShared<FTerrainHorizonOcclusion, ESPMode::ThreadSafe>())
+{
+    PrimaryActorTick.bCanEverTick = true;
+}
+
+void ATerrainOcclusionCuller::BeginPlay()
+{
+    Super::BeginPlay();
+
+    if (!Terrain)
+    {
+        UE_LOG(LogTemp, Warning, TEXT("TerrainOcclusionCuller: Terrain not set."));
+        SetActorTickEnabled(false);
+        return;
+    }
+
+    for (AScatterSpawner* Spawner : Scatterers)
+    {
+        if (Spawner) IsOnTerrain(Spawner, Spawner->Terrain);
+    }
+
+    // Crowds tick after us, so they cull against this frame's sweep
+    for (AHordeCrowd* Crowd : Crowds)
+    {
+        if (Crowd && IsOnTerrain(Crowd, Crowd->Terrain))
+        {
+            Crowd->AddTickPrerequisiteActor(this);
+        }
+    }
+}
+
+void ATerrainOcclusionCuller::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+    ClearOcclusion();
+    Super::EndPlay(EndPlayReason);
+}
+
+bool ATerrainOcclusionCuller::IsOnTerrain(const AActor* Other, const ANoiseTerrainActor* OtherTerrain) const
+{
+    if (OtherTerrain == Terrain) return true;
+
+    UE_LOG(LogTemp, Warning, TEXT("TerrainOcclusionCuller: %s is on another terrain; skipped."), *Other->GetName());
+    return false;
+}
+
+void ATerrainOcclusionCuller::SetCullingEnabled(bool bEnabled)
+{
+    if (bCullingEnabled == bEnabled) return;
+
+    bCullingEnabled = bEnabled;
+    if (!bCullingEnabled)
+    {
+        ClearOcclusion();
+    }
+    LastEye = FVector(FLT_MAX);
+}
+
+float ATerrainOcclusionCuller::GetOccludedTileFraction() const
+{
+    return Occlusion->GetOccludedTileFraction(ScatterInstanceHeight);
+}
+
+void ATerrainOcclusionCuller::Tick(float DeltaSeconds)
+{
+    Super::Tick(DeltaSeconds);
+
+    if (!bCullingEnabled || !Terrain) return;
+
+    const APlayerController* PC = GetWorld() ? GetWorld()->GetFirstPlayerController() : nullptr;
+    if (!PC || !PC->PlayerCameraManager) return;
+
+    const FVector Eye = PC->PlayerCameraManager->GetCameraLocation();
+    if (FVector::DistSquared(Eye, LastEye) < FMath::Square(RecomputeDistance) && Terrain->GetSnapshotVersion() == LastGroundVersion)
+    {
+        return;
+    }
+    UpdateOcclusion(Eye);
+}
+
+void ATerrainOcclusionCuller::UpdateOcclusion(const FVector& Eye)
+{
+    const FTerrainSnapshotPtr Ground = Terrain->GetSnapshot();
+    if (!Ground.IsValid() || !Ground->IsValid()) return;
+
+    const double StartSeconds = FPlatformTime::Seconds();
+
+    // Tile heights only change with the terrain
+    if (Ground->Version != LastGroundVersion)
+    {
+        Occlusion->BuildTiles(Ground.ToSharedRef(), TileQuads);
+        LastGroundVersion = Ground->Version;
+    }
+
+    Occlusion->Update(Ground->ActorTransform.InverseTransformPosition(Eye), NumAzimuthBins);
+    LastEye = Eye;
+
+    NumHiddenScatter = 0;
+    for (AScatterSpawner* Spawner : Scatterers)
+    {
+        if (Spawner && Spawner->Terrain == Terrain)
+        {
+            NumHiddenScatter += Spawner->ApplyOcclusion(&Occlusion.Get(), ScatterInstanceHeight);
+        }
+    }
+    for (AHordeCrowd* Crowd : Crowds)
+    {
+        if (Crowd && Crowd->Terrain == Terrain)
+        {
+            Crowd->SetOcclusion(Occlusion);
+        }
+    }
+
+    UE_LOG(LogTemp, Verbose, TEXT("TerrainOcclusionCuller: swept in %.2f ms, %d scatter instances hidden"),
+        (FPlatformTime::Seconds() - StartSeconds) * 1000.0, NumHiddenScatter);
+}
+
+void ATerrainOcclusionCuller::ClearOcclusion()
+{
+    for (AScatterSpawner* Spawner : Scatterers)
+    {
+        if (IsValid(Spawner))
+        {
+            Spawner->ApplyOcclusion(nullptr, 0.f);
+        }
+    }
+    for (AHordeCrowd* Crowd : Crowds)
+    {
+        if (IsValid(Crowd))
+        {
+            Crowd->SetOcclusion(nullptr);
+        }
+    }
+    NumHiddenScatter = 0;
+}
@@ -0,0 +1,99 @@
+#include "TerrainSnapshot.h"
+#include "TerrainWaterMap.h"
+
+float FTerrainSnapshot::GetHeightAtLocalXY(float LocalX, float LocalY, bool bClampToBounds) const
+{
+    if (!IsValid()) return 0.f;
+
+    float u = (LocalX + NumQuadsX * GridSpacing * 0.5f) / GridSpacing;
+    float v = (LocalY + NumQuadsY * GridSpacing * 0.5f) / GridSpacing;
+
+    if (bClampToBounds) {
+        u = FMath::Clamp(u, 0.f, (float)NumQuadsX);
+        v = FMath::Clamp(v, 0.f, (float)NumQuadsY);
+    }
+    else {
+        if (u < 0.f || u > NumQuadsX || v < 0.f || v > NumQuadsY) return 0.f;
+    }
+
+    return SampleGrid(Heights, u, v);
+}
+
+float FTerrainSnapshot::SampleGrid(const TArray<float>& Values, float U, float V) const
+{
+    const int32 VertsX = NumQuadsX + 1;
+    const int32 ix = FMath::Clamp(FMath::FloorToInt(U), 0, NumQuadsX - 1);
+    const int32 iy = FMath::Clamp(FMath::FloorToInt(V), 0, NumQuadsY - 1);
+    const float tx = U - (float)ix;
+    const float ty = V - (float)iy;
+
+    const float* Row0 = Values.GetData() + iy * VertsX + ix;
+    const float* Row1 = Row0 + VertsX;
+    return FMath::Lerp(FMath::Lerp(Row0[0], Row0[1], tx), FMath::Lerp(Row1[0], Row1[1], tx), ty);
+}
+
+float FTerrainSnapshot::GetHeightAtWorldXY(float WorldX, float WorldY, bool bClampToBounds) const
+{
+    const FVector L = ActorTransform.InverseTransformPosition(FVector(WorldX, WorldY, 0.f));
+    return GetHeightAtLocalXY(L.X, L.Y, bClampToBounds);
+}
+
+FVector FTerrainSnapshot::GetNormalAtWorldXY(float WorldX, float WorldY, bool bClampToBounds) const
+{
+    if (GridSpacing <= 0.f) return FVector::UpVector;
+
+    // Central differences one cell apart in terrain-local space, where GridSpacing and the heights live
+    const FVector L = ActorTransform.InverseTransformPosition(FVector(WorldX, WorldY, 0.f));
+    const float LX = (float)L.X;
+    const float LY = (float)L.Y;
+
+    const float hR = GetHeightAtLocalXY(LX + GridSpacing, LY, bClampToBounds);
+    const float hL = GetHeightAtLocalXY(LX - GridSpacing, LY, bClampToBounds);
+    const float hF = GetHeightAtLocalXY(LX, LY + GridSpacing, bClampToBounds);
+    const float hB = GetHeightAtLocalXY(LX, LY - GridSpacing, bClampToBounds);
+
+    // Tangents to world before the cross, so rotation and non-uniform scale carry through
+    const FVector dX = ActorTransform.TransformVector(FVector(2.f * GridSpacing, 0.f, hR - hL));
+    const FVector dY = ActorTransform.TransformVector(FVector(0.f, 2.f * GridSpacing, hF - hB));
+
+    // X then Y, so the normal faces up (+Z)
+    const FVector N = FVector::CrossProduct(dX, dY);
+    const double Len2 = N.SizeSquared();
+    return (Len2 < 1e-12) ? FVector::UpVector : N / FMath::Sqrt(Len2);
+}
+
+float FTerrainSnapshot::GetShoreDistanceAtWorldXY(float WorldX, float WorldY) const
+{
+    if (!IsValid() || ShoreDistance.Num() != Heights.Num()) return FTerrainWaterMap::NoShoreDistance;
+
+    const FVector L = ActorTransform.InverseTransformPosition(FVector(WorldX, WorldY, 0.f));
+    const float u = FMath::Clamp(((float)L.X + NumQuadsX * GridSpacing * 0.5f) / GridSpacing, 0.f, (float)NumQuadsX);
+    const float v = FMath::Clamp(((float)L.Y + NumQuadsY * GridSpacing * 0.5f) / GridSpacing, 0.f, (float)NumQuadsY);
+    return SampleGrid(ShoreDistance, u, v);
+}
+
+float FTerrainSnapshot::GetFlattenWeightAtLocalXY(float LocalX, float LocalY) const
+{
+    if (!bEnableFlatten) return 0.f;
+
+    const float sx = FMath::Abs(LocalX - (float)FlattenCenter.X) - 0.5f * (float)FlattenSize.X;
+    const float sy = FMath::Abs(LocalY - (float)FlattenCenter.Y) - 0.5f * (float)FlattenSize.Y;
+    const float t = FMath::Clamp(FMath::Max(sx, sy) / FMath::Max(FlattenFalloff, 1.f), 0.f, 1.f);
+    return 1.f - t * t * (3.f - 2.f * t);
+}
+
+bool FTerrainSnapshot::HasLineOfSightLocal(const FVector& From, const FVector& To) const
+{
+    if (!IsValid()) return true;
+
+    const float Dist2D = (float)FVector::Dist2D(From, To);
+    const int32 Steps = FMath::CeilToInt(Dist2D / (0.5f * GridSpacing));
+
+    // Endpoints excluded: both usually sit on (or just above) the ground
+    for (int32 s = 1; s < Steps; ++s)
+    {
+        const FVector P = FMath::Lerp(From, To, (double)s / (double)Steps);
+        if (GetHeightAtLocalXY((float)P.X, (float)P.Y) > (float)P.Z) return false;
+    }
+    return true;
+}
@@ -0,0 +1,190 @@
+#include "TerrainSpawnZones.h"
+#include "Async/ParallelFor.h"
+
+void FTerrainSpawnZones::Reset()
+{
+    NumQuadsX = NumQuadsY = 0;
+    Cells.Reset();
+    ZoneStart.Reset();
+    ZoneCentroids.Reset();
+}
+
+void FTerrainSpawnZones::Build(const TArray<float>& Heights, const TArray<FVector>& Normals, int32 InNumQuadsX, int32 InNumQuadsY,
+    float InGridSpacing, float WaterZ, const FVector2D& BaseLocalXY, const FTerrainSpawnZoneSettings& Settings)
+{
+    const int32 VertsX = InNumQuadsX + 1;
+    const int32 VertsY = InNumQuadsY + 1;
+    if (InNumQuadsX <= 0 || InNumQuadsY <= 0 || Heights.Num() != VertsX * VertsY || Normals.Num() != Heights.Num())
+    {
+        Reset();
+        return;
+    }
+
+    NumQuadsX = InNumQuadsX;
+    NumQuadsY = InNumQuadsY;
+    GridSpacing = InGridSpacing;
+
+    const int32 NumZones = FMath::Max(Settings.NumZones, 1);
+    const float MinNormalZ = FMath::Cos(FMath::DegreesToRadians(FMath::Clamp(Settings.MaxSlopeDeg, 0.f, 90.f)));
+    const float MinZ = WaterZ + Settings.WaterClearance;
+
+    // --- Walkable vertices ---
+    Walkable.SetNumUninitialized(VertsX * VertsY, EAllowShrinking::No);
+    ParallelFor(VertsY, [&](int32 y)
+    {
+        for (int32 x = 0; x < VertsX; ++x)
+        {
+            const int32 i = y * VertsX + x;
+            Walkable[i] = (Heights[i] >= MinZ && Normals[i].Z >= MinNormalZ) ? 1 : 0;
+        }
+    });
+
+    FloodFromBase(BaseLocalXY);
+
+    // --- Candidate quads: all corners reachable, in the perimeter band, away from the base ---
+    const float HalfW = NumQuadsX * GridSpacing * 0.5f;
+    const float HalfH = NumQuadsY * GridSpacing * 0.5f;
+    const float MinBaseDist2 = FMath::Square(FMath::Max(Settings.MinBaseDistance, 0.f));
+    const float SectorSize = 2.f * PI / NumZones;
+
+    CellZones.SetNumUninitialized(NumQuadsX * NumQuadsY, EAllowShrinking::No);
+    ParallelFor(NumQuadsY, [&](int32 cy)
+    {
+        for (int32 cx = 0; cx < NumQuadsX; ++cx)
+        {
+            int32& Zone = CellZones[cy * NumQuadsX + cx];
+            Zone = INDEX_NONE;
+
+            const int32 v00 = cy * VertsX + cx;
+            if (!Reachable[v00] || !Reachable[v00 + 1] || !Reachable[v00 + VertsX] || !Reachable[v00 + VertsX + 1]) continue;
+
+            const float LocalX = (cx + 0.5f) * GridSpacing - HalfW;
+            const float LocalY = (cy + 0.5f) * GridSpacing - HalfH;
+            const float EdgeDist = FMath::Min(HalfW - FMath::Abs(LocalX), HalfH - FMath::Abs(LocalY));
+            if (Settings.EdgeBand > 0.f && EdgeDist > Settings.EdgeBand) continue;
+
+            const float DX = LocalX - (float)BaseLocalXY.X;
+            const float DY = LocalY - (float)BaseLocalXY.Y;
+            if (DX * DX + DY * DY < MinBaseDist2) continue;
+
+            // Sector 0 starts at +X and they run counter-clockwise
+            float Angle = FMath::Atan2(DY, DX);
+            if (Angle < 0.f) Angle += 2.f * PI;
+            Zone = FMath::Min((int32)(Angle / SectorSize), NumZones - 1);
+        }
+    });
+
+    // --- Counting sort by zone ---
+    ZoneStart.SetNumUninitialized(NumZones + 1, EAllowShrinking::No);
+    FMemory::Memzero(ZoneStart.GetData(), ZoneStart.Num() * sizeof(int32));
+    for (const int32 Zone : CellZones)
+    {
+        if (Zone != INDEX_NONE) ++ZoneStart[Zone + 1];
+    }
+    for (int32 z = 0; z < NumZones; ++z)
+    {
+        ZoneStart[z + 1] += ZoneStart[z];
+    }
+
+    // FloodQueue is done with; reuse it as the per-zone write cursor
+    TArray<int32>& Cursor = FloodQueue;
+    Cursor.SetNumUninitialized(NumZones, EAllowShrinking::No);
+    FMemory::Memcpy(Cursor.GetData(), ZoneStart.GetData(), NumZones * sizeof(int32));
+
+    Cells.SetNumUninitialized(ZoneStart[NumZones], EAllowShrinking::No);
+    ZoneCentroids.SetNumUninitialized(NumZones, EAllowShrinking::No);
+    FMemory::Memzero(ZoneCentroids.GetData(), NumZones * sizeof(FVector2f));
+
+    for (int32 Cell = 0; Cell < CellZones.Num(); ++Cell)
+    {
+        const int32 Zone = CellZones[Cell];
+        if (Zone == INDEX_NONE) continue;
+
+        Cells[Cursor[Zone]++] = Cell;
+        ZoneCentroids[Zone] += FVector2f((Cell % NumQuadsX + 0.5f) * GridSpacing - HalfW, (Cell / NumQuadsX + 0.5f) * GridSpacing - HalfH);
+    }
+    for (int32 z = 0; z < NumZones; ++z)
+    {
+        const int32 Count = ZoneStart[z + 1] - ZoneStart[z];
+        if (Count > 0) ZoneCentroids[z] /= (float)Count;
+    }
+}
+
+void FTerrainSpawnZones::FloodFromBase(const FVector2D& BaseLocalXY)
+{
+    const int32 VertsX = NumQuadsX + 1;
+    const int32 VertsY = NumQuadsY + 1;
+
+    Reachable.SetNumUninitialized(VertsX * VertsY, EAllowShrinking::No);
+    FMemory::Memzero(Reachable.GetData(), Reachable.Num());
+
+    // The base itself may sit on a slab or a slope; start from the closest walkable vertex
+    const float U = ((float)BaseLocalXY.X + NumQuadsX * GridSpacing * 0.5f) / GridSpacing;
+    const float V = ((float)BaseLocalXY.Y + NumQuadsY * GridSpacing * 0.5f) / GridSpacing;
+    int32 Start = INDEX_NONE;
+    float BestDist2 = FLT_MAX;
+    for (int32 i = 0; i < Walkable.Num(); ++i)
+    {
+        if (!Walkable[i]) continue;
+        const float D2 = FMath::Square(i % VertsX - U) + FMath::Square(i / VertsX - V);
+        if (D2 < BestDist2)
+        {
+            BestDist2 = D2;
+            Start = i;
+        }
+    }
+    if (Start == INDEX_NONE) return;
+
+    // Each vertex is queued at most once, so the queue is a flat array with a read cursor
+    FloodQueue.SetNumUninitialized(VertsX * VertsY, EAllowShrinking::No);
+    int32 Head = 0, Tail = 0;
+    FloodQueue[Tail++] = Start;
+    Reachable[Start] = 1;
+
+    auto Visit = [&](int32 i)
+    {
+        if (Walkable[i] && !Reachable[i])
+        {
+            Reachable[i] = 1;
+            FloodQueue[Tail++] = i;
+        }
+    };
+
+    while (Head < Tail)
+    {
+        const int32 i = FloodQueue[Head++];
+        const int32 x = i % VertsX;
+        const int32 y = i / VertsX;
+        if (x > 0) Visit(i - 1);
+        if (x < VertsX - 1) Visit(i + 1);
+        if (y > 0) Visit(i - VertsX);
+        if (y < VertsY - 1) Visit(i + VertsX);
+    }
+}
+
+int32 FTerrainSpawnZones::GetZoneCellCount(int32 Zone) const
+{
+    if (!IsValid()) return 0;
+    if (Zone == INDEX_NONE) return Cells.Num();
+    return Zone >= 0 && Zone < GetNumZones() ? ZoneStart[Zone + 1] - ZoneStart[Zone] : 0;
+}
+
+bool FTerrainSpawnZones::Draw(int32 Zone, FRandomStream& Stream, FVector2f& OutLocalXY) const
+{
+    if (GetZoneCellCount(Zone) <= 0) return false;
+
+    const int32 First = Zone == INDEX_NONE ? 0 : ZoneStart[Zone];
+    const int32 Last = Zone == INDEX_NONE ? Cells.Num() - 1 : ZoneStart[Zone + 1] - 1;
+    const int32 Cell = Cells[Stream.RandRange(First, Last)];
+
+    OutLocalXY.X = (Cell % NumQuadsX + Stream.FRand()) * GridSpacing - NumQuadsX * GridSpacing * 0.5f;
+    OutLocalXY.Y = (Cell / NumQuadsX + Stream.FRand()) * GridSpacing - NumQuadsY * GridSpacing * 0.5f;
+    return true;
+}
+
+SIZE_T FTerrainSpawnZones::GetAllocatedSize() const
+{
+    return Cells.GetAllocatedSize() + ZoneStart.GetAllocatedSize() + ZoneCentroids.GetAllocatedSize()
+        + Walkable.GetAllocatedSize() + Reachable.GetAllocatedSize() + FloodQueue.GetAllocatedSize()
+        + CellZones.GetAllocatedSize();
+}
@@ -0,0 +1,110 @@
+#include "TerrainViewshed.h"
+
+void FTerrainViewshed::Reset()
+{
+    Rect = FIntRect();
+    RectWidth = 0;
+    Visible.Reset();
+    Horizon.Reset();
+    NumVisible = 0;
+    NumCells = 0;
+}
+
+void FTerrainViewshed::Compute(const TArray<float>& Heights, int32 VertsX, int32 VertsY,
+    int32 ObserverX, int32 ObserverY, float ObserverZ, float TargetHeight, float RadiusCells)
+{
+    Visible.Reset();
+    NumVisible = 0;
+    NumCells = 0;
+
+    if (VertsX < 1 || VertsY < 1 || Heights.Num() != VertsX * VertsY) return;
+    if (ObserverX < 0 || ObserverY < 0 || ObserverX >= VertsX || ObserverY >= VertsY) return;
+
+    const int32 R = FMath::Max(FMath::FloorToInt(RadiusCells), 0);
+    const int32 R2 = FMath::FloorToInt(RadiusCells * RadiusCells);
+
+    Rect.Min = FIntPoint(FMath::Max(ObserverX - R, 0), FMath::Max(ObserverY - R, 0));
+    Rect.Max = FIntPoint(FMath::Min(ObserverX + R, VertsX - 1), FMath::Min(ObserverY + R, VertsY - 1));
+    RectWidth = Rect.Max.X - Rect.Min.X + 1;
+
+    const int32 NumRect = RectWidth * (Rect.Max.Y - Rect.Min.Y + 1);
+    Visible.Init(false, NumRect);
+    Horizon.SetNumUninitialized(NumRect, EAllowShrinking::No);
+
+    // Rect-local index of an observer-relative offset
+    const int32 OriginIndex = (ObserverY - Rect.Min.Y) * RectWidth + (ObserverX - Rect.Min.X);
+    auto Local = [OriginIndex, this](int32 dx, int32 dy) { return OriginIndex + dy * RectWidth + dx; };
+
+    Visible[OriginIndex] = true;
+    Horizon[OriginIndex] = -BIG_NUMBER;
+    NumVisible = 1;
+    NumCells = 1;
+
+    const int32 MinDX = Rect.Min.X - ObserverX, MaxDX = Rect.Max.X - ObserverX;
+    const int32 MinDY = Rect.Min.Y - ObserverY, MaxDY = Rect.Max.Y - ObserverY;
+
+    auto Visit = [&](int32 dx, int32 dy)
+    {
+        if (dx < MinDX || dx > MaxDX || dy < MinDY || dy > MaxDY) return;
+        const int32 D2 = dx * dx + dy * dy;
+        if (D2 > R2) return;
+
+        const int32 AX = FMath::Abs(dx), AY = FMath::Abs(dy);
+        const int32 K = FMath::Max(AX, AY);
+
+        // Horizon where the ray crosses the previous ring, between the two bracketing vertices.
+        // Those are never farther than this vertex, so they are inside the radius and done.
+        float Prev = -BIG_NUMBER;
+        if (K > 1)
+        {
+            const float Along = (float)(K - 1) / (float)K;
+            if (AX >= AY)
+            {
+                const int32 PX = dx - FMath::Sign(dx);
+                const float T = dy * Along;
+                const int32 Y0 = FMath::FloorToInt(T);
+                const float F = T - Y0;
+                Prev = F > 0.f
+                    ? FMath::Lerp(Horizon[Local(PX, Y0)], Horizon[Local(PX, Y0 + 1)], F)
+                    : Horizon[Local(PX, Y0)];
+            }
+            else
+            {
+                const int32 PY = dy - FMath::Sign(dy);
+                const float T = dx * Along;
+                const int32 X0 = FMath::FloorToInt(T);
+                const float F = T - X0;
+                Prev = F > 0.f
+                    ? FMath::Lerp(Horizon[Local(X0, PY)], Horizon[Local(X0 + 1, PY)], F)
+                    : Horizon[Local(X0, PY)];
+            }
+        }
+
+        const int32 i = Local(dx, dy);
+        const float InvDist = FMath::InvSqrt((float)D2);
+        const float Ground = Heights[(ObserverY + dy) * VertsX + (ObserverX + dx)];
+
+        ++NumCells;
+        if ((Ground + TargetHeight - ObserverZ) * InvDist >= Prev)
+        {
+            Visible[i] = true;
+            ++NumVisible;
+        }
+        Horizon[i] = FMath::Max(Prev, (Ground - ObserverZ) * InvDist);
+    };
+
+    // Rings of increasing Chebyshev distance; each only reads the one before it
+    for (int32 K = 1; K <= R; ++K)
+    {
+        for (int32 dx = -K; dx <= K; ++dx)
+        {
+            Visit(dx, -K);
+            Visit(dx, K);
+        }
+        for (int32 dy = -K + 1; dy <= K - 1; ++dy)
+        {
+            Visit(-K, dy);
+            Visit(K, dy);
+        }
+    }
+}
@@ -0,0 +1,211 @@
+#include "TerrainWaterMap.h"
+#include "Async/ParallelFor.h"
+
+namespace
+{
+    constexpr float EdtInf = 1.0e20f;
+    constexpr int32 EdtLinesPerBlock = 32;
+
+    // 1D squared distance transform: lower envelope of parabolas rooted at F (F = 0 on features)
+    void DistanceTransform1D(const float* F, float* D, int32* V, float* Z, int32 N)
+    {
+        int32 k = 0;
+        V[0] = 0;
+        Z[0] = -EdtInf;
+        Z[1] = +EdtInf;
+
+        auto Intersect = [F](int32 q, int32 p)
+        {
+            return ((F[q] + (float)(q * q)) - (F[p] + (float)(p * p))) / (float)(2 * q - 2 * p);
+        };
+
+        for (int32 q = 1; q < N; ++q)
+        {
+            float s = Intersect(q, V[k]);
+            while (k > 0 && s <= Z[k])
+            {
+                --k;
+                s = Intersect(q, V[k]);
+            }
+            ++k;
+            V[k] = q;
+            Z[k] = s;
+            Z[k + 1] = +EdtInf;
+        }
+
+        k = 0;
+        for (int32 q = 0; q < N; ++q)
+        {
+            while (Z[k + 1] < (float)q) ++k;
+            const float dq = (float)(q - V[k]);
+            D[q] = dq * dq + F[V[k]];
+        }
+    }
+
+    // Squared Euclidean distance transform in place (rows, then columns), in grid units.
+    // Each block of lines works in its own slice of LineScratch / IndexScratch.
+    void DistanceTransform2D(TArray<float>& Grid, int32 W, int32 H, TArray<float>& LineScratch, TArray<int32>& IndexScratch)
+    {
+        auto RunLines = [&](int32 NumLines, int32 LineLength, int32 LineStride, int32 ElemStride)
+        {
+            const int32 NumBlocks = (NumLines + EdtLinesPerBlock - 1) / EdtLinesPerBlock;
+            const int32 FloatsPerBlock = 3 * LineLength + 1;
+            LineScratch.SetNumUninitialized(NumBlocks * FloatsPerBlock, EAllowShrinking::No);
+            IndexScratch.SetNumUninitialized(NumBlocks * LineLength, EAllowShrinking::No);
+
+            ParallelFor(NumBlocks, [&](int32 Block)
+            {
+                float* F = LineScratch.GetData() + Block * FloatsPerBlock;
+                float* D = F + LineLength;
+                float* Z = D + LineLength;  // LineLength + 1
+                int32* V = IndexScratch.GetData() + Block * LineLength;
+
+                const int32 L0 = Block * EdtLinesPerBlock;
+                const int32 L1 = FMath::Min(NumLines, L0 + EdtLinesPerBlock);
+                for (int32 Line = L0; Line < L1; ++Line)
+                {
+                    float* Base = Grid.GetData() + Line * LineStride;
+                    for (int32 i = 0; i < LineLength; ++i) { F[i] = Base[i * ElemStride]; }
+                    DistanceTransform1D(F, D, V, Z, LineLength);
+                    for (int32 i = 0; i < LineLength; ++i) { Base[i * ElemStride] = D[i]; }
+                }
+            });
+        };
+
+        RunLines(H, W, W, 1); // rows
+        RunLines(W, H, 1, W); // columns
+    }
+}
+
+void FTerrainWaterMap::Reset()
+{
+    VertsX = VertsY = 0;
+    BodyIds.Reset();
+    ShoreDistance.Reset();
+    BodyCellCounts.Reset();
+    BodyBounds.Reset();
+}
+
+void FTerrainWaterMap::Build(const TArray<float>& Heights, int32 InVertsX, int32 InVertsY, float GridSpacing, float WaterZ)
+{
+    Reset();
+    if (InVertsX < 1 || InVertsY < 1 || Heights.Num() != InVertsX * InVertsY) return;
+
+    VertsX = InVertsX;
+    VertsY = InVertsY;
+
+    FloodFillBodies(Heights, WaterZ);
+    BuildDistanceField(FMath::Max(GridSpacing, 1.f));
+}
+
+void FTerrainWaterMap::FloodFillBodies(const TArray<float>& Heights, float WaterZ)
+{
+    const int32 Total = VertsX * VertsY;
+    // Fill in place: Init would reallocate on every rebuild
+    BodyIds.SetNumUninitialized(Total, EAllowShrinking::No);
+    for (int32& Id : BodyIds) Id = INDEX_NONE;
+
+    TArray<int32>& Stack = FloodStack;
+    for (int32 Seed = 0; Seed < Total; ++Seed)
+    {
+        if (Heights[Seed] >= WaterZ || BodyIds[Seed] != INDEX_NONE) continue;
+
+        const int32 Body = BodyCellCounts.Add(0);
+        FIntRect& Bounds = BodyBounds.Add_GetRef(FIntRect(Seed % VertsX, Seed / VertsX, Seed % VertsX, Seed / VertsX));
+
+        BodyIds[Seed] = Body;
+        Stack.Reset();
+        Stack.Add(Seed);
+
+        while (Stack.Num() > 0)
+        {
+            const int32 i = Stack.Pop(EAllowShrinking::No);
+            const int32 x = i % VertsX;
+            const int32 y = i / VertsX;
+
+            ++BodyCellCounts[Body];
+            Bounds.Min.X = FMath::Min(Bounds.Min.X, x);
+            Bounds.Min.Y = FMath::Min(Bounds.Min.Y, y);
+            Bounds.Max.X = FMath::Max(Bounds.Max.X, x);
+            Bounds.Max.Y = FMath::Max(Bounds.Max.Y, y);
+
+            auto Visit = [&](int32 n)
+            {
+                if (Heights[n] < WaterZ && BodyIds[n] == INDEX_NONE)
+                {
+                    BodyIds[n] = Body;
+                    Stack.Add(n);
+                }
+            };
+            if (x > 0) Visit(i - 1);
+            if (x < VertsX - 1) Visit(i + 1);
+            if (y > 0) Visit(i - VertsX);
+            if (y < VertsY - 1) Visit(i + VertsX);
+        }
+    }
+}
+
+void FTerrainWaterMap::BuildDistanceField(float GridSpacing)
+{
+    const int32 Total = VertsX * VertsY;
+    if (BodyCellCounts.Num() == 0)
+    {
+        ShoreDistance.SetNumUninitialized(Total, EAllowShrinking::No);
+        for (float& D : ShoreDistance) D = NoShoreDistance;
+        return;
+    }
+
+    // Squared distance from every vertex to the nearest wet / dry vertex
+    ToWater.SetNumUninitialized(Total, EAllowShrinking::No);
+    ToLand.SetNumUninitialized(Total, EAllowShrinking::No);
+    for (int32 i = 0; i < Total; ++i)
+    {
+        const bool bWet = BodyIds[i] != INDEX_NONE;
+        ToWater[i] = bWet ? 0.f : EdtInf;
+        ToLand[i] = bWet ? EdtInf : 0.f;
+    }
+
+    DistanceTransform2D(ToWater, VertsX, VertsY, LineScratch, IndexScratch);
+    DistanceTransform2D(ToLand, VertsX, VertsY, LineScratch, IndexScratch);
+
+    // The shoreline sits between a wet and a dry vertex, half a cell from each
+    ShoreDistance.SetNumUninitialized(Total, EAllowShrinking::No);
+    for (int32 i = 0; i < Total; ++i)
+    {
+        if (BodyIds[i] != INDEX_NONE)
+        {
+            ShoreDistance[i] = (ToLand[i] >= 0.5f * EdtInf) ? -NoShoreDistance
+                : -(FMath::Sqrt(ToLand[i]) - 0.5f) * GridSpacing;
+        }
+        else
+        {
+            ShoreDistance[i] = (FMath::Sqrt(ToWater[i]) - 0.5f) * GridSpacing;
+        }
+    }
+}
+
+float FTerrainWaterMap::SampleShoreDistance(float U, float V) const
+{
+    if (!IsValid()) return NoShoreDistance;
+
+    U = FMath::Clamp(U, 0.f, (float)(VertsX - 1));
+    V = FMath::Clamp(V, 0.f, (float)(VertsY - 1));
+
+    const int32 ix = FMath::Min(FMath::FloorToInt(U), FMath::Max(VertsX - 2, 0));
+    const int32 iy = FMath::Min(FMath::FloorToInt(V), FMath::Max(VertsY - 2, 0));
+    const int32 ix1 = FMath::Min(ix + 1, VertsX - 1);
+    const int32 iy1 = FMath::Min(iy + 1, VertsY - 1);
+    const float tx = U - (float)ix;
+    const float ty = V - (float)iy;
+
+    const float d0 = FMath::Lerp(GetShoreDistanceAt(ix, iy), GetShoreDistanceAt(ix1, iy), tx);
+    const float d1 = FMath::Lerp(GetShoreDistanceAt(ix, iy1), GetShoreDistanceAt(ix1, iy1), tx);
+    return FMath::Lerp(d0, d1, ty);
+}
+
+SIZE_T FTerrainWaterMap::GetAllocatedSize() const
+{
+    return BodyIds.GetAllocatedSize() + ShoreDistance.GetAllocatedSize() + BodyCellCounts.GetAllocatedSize()
+        + BodyBounds.GetAllocatedSize() + FloodStack.GetAllocatedSize() + ToWater.GetAllocatedSize()
+        + ToLand.GetAllocatedSize() + LineScratch.GetAllocatedSize() + IndexScratch.GetAllocatedSize();
+}
@@ -0,0 +1,170 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "HordeSpatialIndex.h"
+#include "TerrainSnapshot.h"
+#include "HordeCrowd.generated.h"
+
+class ANoiseTerrainActor;
+class FTerrainHorizonOcclusion;
+class UInstancedStaticMeshComponent;
+class UStaticMesh;
+
+/**
+ * Data-oriented horde: agents live in flat per-field arrays (terrain-local space), are stepped
+ * in parallel batches, clamped to the terrain through its published snapshot, and drawn as
+ * instances of one mesh. No per-agent actors, components or collision traces.
+ */
+UCLASS()
+class PERLINNOISEGEN_API AHordeCrowd : public AActor
+{
+    GENERATED_BODY()
+
+public:
+    AHordeCrowd();
+
+    // ---- Components ----
+    UPROPERTY(VisibleAnywhere, Category = "Components")
+    UInstancedStaticMeshComponent* Instances;
+
+    // Terrain to walk on (ground heights come from its snapshot)
+    UPROPERTY(EditAnywhere, Category = "Terrain")
+    ANoiseTerrainActor* Terrain = nullptr;
+
+    // ---- Rendering ----
+    UPROPERTY(EditAnywhere, Category = "Crowd|Rendering")
+    UStaticMesh* AgentMesh = nullptr;
+
+    // Lift above the ground (mesh pivot at its feet = 0)
+    UPROPERTY(EditAnywhere, Category = "Crowd|Rendering")
+    float GroundOffset = 0.f;
+
+    // Agent height above its feet; an agent is culled once terrain hides its top
+    UPROPERTY(EditAnywhere, Category = "Crowd|Rendering", meta = (ClampMin = "0.0"))
+    float OcclusionHeight = 200.f;
+
+    // ---- Movement ----
+    // World-space point the horde converges on (the base)
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Crowd|Movement")
+    FVector Goal = FVector::ZeroVector;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Crowd|Movement", meta = (ClampMin = "0.0"))
+    float MaxSpeed = 350.f;
+
+    // Per-agent speed is MaxSpeed * (1 +- SpeedVariance)
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Crowd|Movement", meta = (ClampMin = "0.0", ClampMax = "0.9"))
+    float SpeedVariance = 0.2f;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Crowd|Movement", meta = (ClampMin = "0.0"))
+    float MaxAcceleration = 800.f;
+
+    // Agents slow down inside this distance (cm) of the goal
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Crowd|Movement", meta = (ClampMin = "1.0"))
+    float ArriveRadius = 300.f;
+
+    // ---- Targeting ----
+    // Rebuild the agent bucket grid every tick (needed by FindTargets)
+    UPROPERTY(EditAnywhere, Category = "Crowd|Targeting")
+    bool bBuildSpatialIndex = true;
+
+    // Bucket edge in terrain quads; around a typical turret range / 4 keeps queries to a few buckets
+    UPROPERTY(EditAnywhere, Category = "Crowd|Targeting", meta = (ClampMin = "1", UIMin = "1", UIMax = "64", EditCondition = "bBuildSpatialIndex"))
+    int32 IndexCellQuads = 8;
+
+    // Aim point above an agent's feet, for line-of-sight tests
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Crowd|Targeting", meta = (ClampMin = "0.0"))
+    float TargetHeight = 100.f;
+
+    // ---- Advanced ----
+    // Agents per parallel work item
+    UPROPERTY(EditAnywhere, Category = "Crowd|Advanced", meta = (ClampMin = "16", UIMin = "16", UIMax = "4096"))
+    int32 BatchSize = 256;
+
+    // Adds Count agents scattered uniformly in a disc; returns the index of the first one
+    UFUNCTION(BlueprintCallable, Category = "Crowd")
+    int32 SpawnAgents(int32 Count, FVector WorldCenter, float Radius, int32 Seed = 0);
+
+    // Adds Count agents drawn from one of the terrain's spawn zones (any zone for -1); returns the
+    // index of the first one, or INDEX_NONE if the zone has no cells
+    UFUNCTION(BlueprintCallable, Category = "Crowd")
+    int32 SpawnAgentsInZone(int32 Count, int32 Zone, int32 Seed = 0);
+
+    UFUNCTION(BlueprintCallable, Category = "Crowd")
+    void ClearAgents();
+
+    UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Crowd")
+    int32 GetNumAgents() const { return PosX.Num(); }
+
+    UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Crowd")
+    FVector GetAgentLocation(int32 Index) const;
+
+    // Agents within Radius (horizontal) of WorldEye: the MaxTargets nearest, closest first, or
+    // all of them unordered if MaxTargets <= 0. Indices refer to the last tick.
+    UFUNCTION(BlueprintCallable, Category = "Crowd|Targeting")
+    int32 FindTargets(FVector WorldEye, float Radius, int32 MaxTargets, bool bRequireLineOfSight, TArray<int32>& OutAgents) const;
+
+    // Many turrets at once; query origins are in world space, queries run in parallel
+    void FindTargetsBatch(TArrayView<const FHordeTargetQuery> WorldQueries, FHordeQueryResults& Out) const;
+
+    // Agents the terrain hides from Occlusion's eye are drawn at zero scale from the next tick on;
+    // set by ATerrainOcclusionCuller, null draws everyone
+    void SetOcclusion(TSharedPtr<const FTerrainHorizonOcclusion, ESPMode::ThreadSafe> InOcclusion);
+
+    // Agents culled by the last instance update
+    int32 GetNumOccludedAgents() const { return NumOccludedAgents; }
+
+    // Terrain-local index as of the last tick
+    const FHordeSpatialIndex& GetSpatialIndex() const { return SpatialIndex; }
+
+    // Terrain-local -> world (identity without a terrain)
+    const FTransform& GetCrowdTransform() const { return CrowdToWorld; }
+
+    // Raw SoA views, terrain-local
+    const TArray<float>& GetPositionsX() const { return PosX; }
+    const TArray<float>& GetPositionsY() const { return PosY; }
+    const TArray<float>& GetPositionsZ() const { return PosZ; }
+
+    virtual void Tick(float DeltaSeconds) override;
+
+protected:
+    virtual void OnConstruction(const FTransform& Transform) override;
+
+private:
+    // Appends Count agents at PickXY's terrain-local positions, then grounds them and grows the instances
+    int32 AddAgents(int32 Count, int32 Seed, float StartZ, TFunctionRef<FVector2f(FRandomStream&)> PickXY);
+
+    void StepAgents(const FTerrainSnapshot* Ground, float DeltaSeconds);
+    void ClampToGround(const FTerrainSnapshot& Ground);
+    void UpdateInstances();
+
+    void RefreshCrowdTransform(const FTerrainSnapshot* Ground);
+    void RebuildSpatialIndex(const FTerrainSnapshot* Ground);
+
+    // ---- Agent state (SoA, terrain-local) ----
+    TArray<float> PosX;
+    TArray<float> PosY;
+    TArray<float> PosZ;
+    TArray<float> VelX;
+    TArray<float> VelY;
+    TArray<float> AgentMaxSpeed;
+    TArray<float> Yaw;           // degrees, from the last non-zero velocity
+
+    // Grid cell each agent was last clamped in; re-used as the start of the next lookup
+    TArray<FIntPoint> GroundCell;
+    uint64 GroundVersion = 0;    // snapshot the cells refer to
+
+    FTransform CrowdToWorld = FTransform::Identity;
+
+    FHordeSpatialIndex SpatialIndex;
+
+    // Snapshot the index was built against (line-of-sight tests use the same heights)
+    FTerrainSnapshotPtr IndexGround;
+
+    // Scratch for the instance update, kept between frames
+    TArray<FTransform> InstanceTransforms;
+
+    // Terrain-local like the agents
+    TSharedPtr<const FTerrainHorizonOcclusion, ESPMode::ThreadSafe> Occlusion;
+    int32 NumOccludedAgents = 0;
+};
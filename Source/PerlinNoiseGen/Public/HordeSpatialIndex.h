@@ -0,0 +1,84 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+class FTerrainSnapshot;
+
+/** One targeting query, in the index's (terrain-local) space. */
+struct FHordeTargetQuery
+{
+    // Z is the eye height used for line of sight
+    FVector Origin = FVector::ZeroVector;
+
+    // Horizontal range (cm)
+    float Radius = 0.f;
+
+    // 0 = every agent in range, unordered; otherwise the K nearest, closest first
+    int32 MaxResults = 0;
+
+    // Drop agents whose aim point (TargetHeight above their feet) is hidden by the terrain
+    bool bRequireLineOfSight = false;
+    float TargetHeight = 100.f;
+};
+
+/** Hits of a batch of queries, stored back to back. */
+struct FHordeQueryResults
+{
+    TArray<int32> Agents;
+    TArray<int32> Start;    // per query
+    TArray<int32> Count;    // per query
+
+    TArrayView<const int32> Get(int32 Query) const
+    {
+        return TArrayView<const int32>(Agents.GetData() + Start[Query], Count[Query]);
+    }
+};
+
+/**
+ * Uniform-grid bucket index over agent positions, rebuilt every frame by a parallel counting
+ * sort (cell per agent, atomic histogram, prefix sum, atomic scatter). Buckets hold copies of
+ * the positions, so queries touch only the index. Capacity is kept between rebuilds.
+ */
+class PERLINNOISEGEN_API FHordeSpatialIndex
+{
+public:
+    // Buckets of CellSize over [Min, Max]; agents outside land in the edge buckets
+    void Build(const TArray<float>& X, const TArray<float>& Y, const TArray<float>& Z,
+        const FVector2f& Min, const FVector2f& Max, float InCellSize);
+    void Reset();
+
+    int32 Num() const { return SortedAgent.Num(); }
+    bool IsValid() const { return CellsX > 0; }
+
+    // Ground (optional) is only needed for line-of-sight queries
+    void RunQuery(const FHordeTargetQuery& Query, const FTerrainSnapshot* Ground, TArray<int32>& OutAgents) const;
+
+    // Query for each entry, in parallel
+    void RunQueryBatch(TArrayView<const FHordeTargetQuery> Queries, const FTerrainSnapshot* Ground, FHordeQueryResults& Out) const;
+
+private:
+    FORCEINLINE int32 CellCoordX(float X) const { return FMath::Clamp(FMath::FloorToInt((X - Origin.X) * InvCellSize), 0, CellsX - 1); }
+    FORCEINLINE int32 CellCoordY(float Y) const { return FMath::Clamp(FMath::FloorToInt((Y - Origin.Y) * InvCellSize), 0, CellsY - 1); }
+
+    bool PassesLineOfSight(const FHordeTargetQuery& Query, const FTerrainSnapshot* Ground, int32 Slot) const;
+
+    void QueryAllInRange(const FHordeTargetQuery& Query, const FTerrainSnapshot* Ground, TArray<int32>& OutAgents) const;
+    void QueryNearest(const FHordeTargetQuery& Query, const FTerrainSnapshot* Ground, TArray<int32>& OutAgents) const;
+
+    FVector2f Origin = FVector2f::ZeroVector;
+    float CellSize = 1.f;
+    float InvCellSize = 1.f;
+    int32 CellsX = 0;
+    int32 CellsY = 0;
+
+    // Bucket c holds slots [CellStart[c], CellStart[c + 1])
+    TArray<int32> CellStart;
+    TArray<int32> SortedAgent;
+    TArray<float> SortedX;
+    TArray<float> SortedY;
+    TArray<float> SortedZ;
+
+    // Build scratch
+    TArray<int32> AgentCell;
+    TArray<int32> CellCursor;
+};
@@ -0,0 +1,94 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "Tasks/Task.h"
+#include "MatchGenerationPipeline.generated.h"
+
+class ANoiseTerrainActor;
+class AScatterSpawner;
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnMatchGenerationProgress, float, Progress, FName, Stage);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE(FOnMatchGenerationComplete);
+
+/**
+ * Match-start generation as a task graph: terrain heights on a worker, then each scatterer's
+ * placement on a worker once the heights exist. Their game-thread commits (mesh upload,
+ * collision, actor spawns) run from Tick, in order, within FrameBudgetMs per frame, so a loading
+ * screen can keep animating and bind to OnProgress / OnComplete.
+ */
+UCLASS()
+class PERLINNOISEGEN_API AMatchGenerationPipeline : public AActor
+{
+    GENERATED_BODY()
+
+public:
+    AMatchGenerationPipeline();
+
+    UPROPERTY(EditAnywhere, Category = "Generation")
+    ANoiseTerrainActor* Terrain = nullptr;
+
+    // Scattered after the terrain, in this order
+    UPROPERTY(EditAnywhere, Category = "Generation")
+    TArray<AScatterSpawner*> Scatterers;
+
+    UPROPERTY(EditAnywhere, Category = "Generation")
+    bool bStartOnBeginPlay = true;
+
+    // Game-thread time per frame for commit steps (one step may overrun it)
+    UPROPERTY(EditAnywhere, Category = "Generation", meta = (ClampMin = "0.1"))
+    float FrameBudgetMs = 4.f;
+
+    // Hold completion until every terrain collision tile has cooked
+    UPROPERTY(EditAnywhere, Category = "Generation")
+    bool bWaitForCollision = true;
+
+    // 0..1 overall, with the stage currently committing
+    UPROPERTY(BlueprintAssignable, Category = "Generation")
+    FOnMatchGenerationProgress OnProgress;
+
+    UPROPERTY(BlueprintAssignable, Category = "Generation")
+    FOnMatchGenerationComplete OnComplete;
+
+    // Restarts if already running (waits for in-flight worker tasks first)
+    UFUNCTION(BlueprintCallable, Category = "Generation")
+    void StartGeneration();
+
+    UFUNCTION(BlueprintPure, Category = "Generation")
+    bool IsGenerating() const { return Stages.IsValidIndex(CurrentStage); }
+
+    UFUNCTION(BlueprintPure, Category = "Generation")
+    float GetProgress() const;
+
+    virtual void Tick(float DeltaSeconds) override;
+
+protected:
+    virtual void BeginPlay() override;
+    virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+private:
+    /** One game-thread step of the graph; runs once its worker prerequisite is done. */
+    struct FStage
+    {
+        FName Name;
+
+        // Share of the overall progress
+        float Weight = 1.f;
+
+        // Worker task whose output this stage commits (may be empty)
+        UE::Tasks::FTask Prerequisite;
+
+        // Does as much as fits before the deadline (FPlatformTime::Seconds); true when finished
+        TFunction<bool(double)> Commit;
+
+        // 0..1 within the stage, for progress between commit slices (optional)
+        TFunction<float()> Progress;
+    };
+
+    void WaitForWorkers();
+
+    TArray<FStage> Stages;
+    TArray<UE::Tasks::FTask> WorkerTasks;
+    int32 CurrentStage = INDEX_NONE;
+    double StartSeconds = 0.0;
+};
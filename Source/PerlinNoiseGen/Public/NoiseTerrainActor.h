@@ -2,13 +2,48 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
+#include "HAL/CriticalSection.h"
+#include "TerrainErosion.h"
+#include "TerrainWaterMap.h"
+#include "TerrainFootprintTables.h"
+#include "TerrainSpawnZones.h"
+#include "TerrainViewshed.h"
+#include "TerrainSnapshot.h"
+#include "TerrainDebugOverlay.h"
+#include "ProceduralMeshComponent.h"    // FProcMeshTangent, held by the staged build
+#include "TerrainMeshComponent.h"       // FTerrainMeshData, likewise
 #include "NoiseTerrainActor.generated.h"
 
 // Forward declarations to keep the public header light
 class UProceduralMeshComponent;
+class UTerrainMeshComponent;
+class UBodySetup;
 struct FProcMeshTangent;
 class FPerlinNoise;
 
+UENUM(BlueprintType)
+enum class ETerrainCollisionMode : uint8
+{
+    // Cook the full-resolution render section as one triangle mesh
+    FullMesh,
+    // Decimated collision split into tiles, each cooked in the background on its own
+    CoarseTiles,
+    // No physics geometry; gameplay uses the height queries / RaycastTerrain only
+    None
+};
+
+UENUM(BlueprintType)
+enum class ETerrainNoiseSpace : uint8
+{
+    // Noise follows this actor's own grid indices; the terrain can't line up with another actor
+    Index,
+    // Noise follows the world grid (world XY / GridSpacing), so neighbouring actors tile seamlessly
+    World
+};
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnTerrainCollisionTileReady, int32, TileIndex);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE(FOnTerrainCollisionReady);
+
 UCLASS()
 class PERLINNOISEGEN_API ANoiseTerrainActor : public AActor
 {
@@ -21,6 +56,14 @@ public:
     UPROPERTY(VisibleAnywhere, Category = "Components")
     UProceduralMeshComponent* ProcMesh;
 
+    // Renders the terrain surface when bUseCompactTerrainMesh is on
+    UPROPERTY(VisibleAnywhere, Category = "Components")
+    UTerrainMeshComponent* TerrainMesh;
+
+    // Vertex-colored copy of the surface for DebugOverlay (hidden while it is None)
+    UPROPERTY(VisibleAnywhere, Category = "Components")
+    UTerrainMeshComponent* DebugOverlayMesh;
+
     // ---- Grid ----
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Terrain|Grid", meta = (ClampMin = "1", UIMin = "1"))
     int32 NumQuadsX = 200;
@@ -55,29 +98,182 @@ public:
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Terrain|Noise")
     FVector2D NoiseOffset = FVector2D(37.123f, 53.789f);
 
+    // World: actors with the same grid spacing, noise and erosion settings share their border heights
+    // and normals. Place them unrotated and unscaled, with their corners on the world grid
+    // (location = (k + NumQuads / 2) * GridSpacing), flatten pads clear of the edges. Each still builds,
+    // cooks and streams on its own.
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Terrain|Noise")
+    ETerrainNoiseSpace NoiseSpace = ETerrainNoiseSpace::Index;
+
     // Optional single-pass height smoothing to tame razor peaks
     //UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Terrain|Noise")
     //bool bSmoothHeights = false;
 
+    // ---- Erosion ----
+    // Optional stage between height sampling and mesh build (deterministic per Seed)
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Terrain|Erosion")
+    bool bEnableErosion = false;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Terrain|Erosion", meta = (EditCondition = "bEnableErosion"))
+    FTerrainErosionSettings Erosion;
+
+    // World noise: quads of the neighbours' ground eroded along with ours, so water running in from
+    // outside still carves the edge region
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Terrain|Erosion", meta = (EditCondition = "bEnableErosion && NoiseSpace == ETerrainNoiseSpace::World", ClampMin = "0", UIMin = "0"))
+    int32 WorldErosionApron = 32;
+
+    // World noise: erosion fades out over this many quads toward the edges; the outer two vertex rows
+    // stay pure noise, which is what makes them match the neighbour's
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Terrain|Erosion", meta = (EditCondition = "bEnableErosion && NoiseSpace == ETerrainNoiseSpace::World", ClampMin = "1", UIMin = "1"))
+    int32 WorldErosionEdgeFade = 16;
+
+    // Reuse eroded heights from Saved/TerrainCache when every generation parameter matches
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Terrain|Erosion", meta = (EditCondition = "bEnableErosion"))
+    bool bCacheErodedHeights = true;
+
     // ---- Mesh ----
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Terrain|Mesh")
     bool bCreateCollision = true;
 
+    // Render through UTerrainMeshComponent (compact vertices, 16-bit tiled indices) instead of a ProcMesh section
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Terrain|Mesh")
+    bool bUseCompactTerrainMesh = true;
+
+    // Quads per render tile side (compact mesh); one draw per tile
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Terrain|Mesh", meta = (EditCondition = "bUseCompactTerrainMesh", ClampMin = "8", UIMin = "8", ClampMax = "254", UIMax = "254"))
+    int32 RenderTileQuads = 64;
+
+    // ---- Memory ----
+    // Keep the build's grid arrays, mesh data and scratch between builds, so regenerating at the
+    // same size allocates nothing on our side (engine ProcMesh sections and cooking still do).
+    // Off frees them once each build is committed.
+    UPROPERTY(EditAnywhere, Category = "Terrain|Memory")
+    bool bRetainGenerationBuffers = true;
+
+    // Frees the retained buffers now; call between builds, not while a staged build is committing
+    UFUNCTION(CallInEditor, Category = "Terrain|Memory")
+    void ReleaseGenerationBuffers();
+
+    // Bytes the build holds: height cache, water/footprint tables, snapshot spare and retained buffers
+    UFUNCTION(BlueprintPure, Category = "Terrain|Memory")
+    int64 GetGenerationMemoryBytes() const;
+
+    // Most GetGenerationMemoryBytes has been during a build (reset by ReleaseGenerationBuffers)
+    UFUNCTION(BlueprintPure, Category = "Terrain|Memory")
+    int64 GetPeakGenerationMemoryBytes() const { return PeakGenerationMemoryBytes; }
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Terrain|Collision", meta = (EditCondition = "bCreateCollision"))
+    ETerrainCollisionMode CollisionMode = ETerrainCollisionMode::CoarseTiles;
+
+    // Full-res quads per collision tile side (CoarseTiles)
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Terrain|Collision", meta = (ClampMin = "4", UIMin = "4", UIMax = "256"))
+    int32 CollisionTileQuads = 64;
+
+    // Keep every Nth vertex in collision tiles; tile borders are always kept so tiles stay watertight
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Terrain|Collision", meta = (ClampMin = "1", UIMin = "1", UIMax = "8"))
+    int32 CollisionStride = 2;
+
+    // Tiles cooking at once; the rest wait in a queue ordered by distance to the pad / player
+    // (tiles re-cooked after a deformation jump the queue)
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Terrain|Collision", meta = (ClampMin = "1", UIMin = "1", UIMax = "64"))
+    int32 MaxConcurrentCollisionCooks = 8;
+
+    // Fired per tile as its collision becomes usable (CoarseTiles)
+    UPROPERTY(BlueprintAssignable, Category = "Terrain|Collision")
+    FOnTerrainCollisionTileReady OnCollisionTileReady;
+
+    // Fired once every collision tile is ready
+    UPROPERTY(BlueprintAssignable, Category = "Terrain|Collision")
+    FOnTerrainCollisionReady OnCollisionReady;
+
+    UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Terrain|Collision")
+    bool IsCollisionReadyAtWorldXY(float WorldX, float WorldY) const;
+
+    // 0..1 share of collision tiles that are cooked (1 for FullMesh, 0 for None)
+    UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Terrain|Collision")
+    float GetCollisionReadyFraction() const;
+
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Terrain|Mesh")
     UMaterialInterface* TerrainMaterial = nullptr;
 
+    // ---- Blend weights ----
+    // Baked into vertex colors so the terrain material can read them instead of doing
+    // per-pixel slope/height math: R = slope (rock), G = height band, B = water proximity (sand),
+    // A = flatten pad mask. All 0..1.
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Terrain|Blend")
+    bool bBakeBlendWeights = true;
+
+    // Slope (deg) where R starts ramping up, and where it reaches 1
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Terrain|Blend", meta = (EditCondition = "bBakeBlendWeights", ClampMin = "0.0", ClampMax = "90.0"))
+    float BlendSlopeStartDeg = 30.f;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Terrain|Blend", meta = (EditCondition = "bBakeBlendWeights", ClampMin = "0.0", ClampMax = "90.0"))
+    float BlendSlopeEndDeg = 45.f;
+
+    // Height (cm) band over which G ramps from 0 to 1
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Terrain|Blend", meta = (EditCondition = "bBakeBlendWeights"))
+    float BlendHeightLow = 200.f;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Terrain|Blend", meta = (EditCondition = "bBakeBlendWeights"))
+    float BlendHeightHigh = 500.f;
+
+    // B is 1 under water and at the shoreline, fading to 0 this far (cm) inland
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Terrain|Blend", meta = (EditCondition = "bBakeBlendWeights", ClampMin = "1.0"))
+    float BlendShoreWidth = 300.f;
+
     // Rebuild (shows as a button in Details panel)
     UFUNCTION(CallInEditor, BlueprintCallable, Category = "Terrain")
     void Regenerate();
 
+    // ---- Preview ----
+    // Editor only: an edit first shows every PreviewStride-th vertex of the (uneroded) noise, then
+    // refines, halving the stride each tick once edits pause, down to the full build. Collision,
+    // erosion, slab, water and the debug overlay wait for that last pass; a new edit starts over.
+    UPROPERTY(EditAnywhere, Category = "Terrain|Preview")
+    bool bProgressivePreview = true;
+
+    UPROPERTY(EditAnywhere, Category = "Terrain|Preview", meta = (EditCondition = "bProgressivePreview", ClampMin = "2", ClampMax = "64"))
+    int32 PreviewStride = 8;
+
+    // Seconds without edits before refining past the first pass (keeps slider drags coarse)
+    UPROPERTY(EditAnywhere, Category = "Terrain|Preview", meta = (EditCondition = "bProgressivePreview", ClampMin = "0.0"))
+    float PreviewRefineDelay = 0.15f;
+
+    // ---- Debug ----
+    // Rebuilt from the snapshot on every build and after deformation settles
+    UPROPERTY(EditAnywhere, Category = "Terrain|Debug")
+    ETerrainDebugOverlay DebugOverlay = ETerrainDebugOverlay::None;
+
+    // Overlay vertex every N grid vertices (large maps stay cheap at 2-4)
+    UPROPERTY(EditAnywhere, Category = "Terrain|Debug", meta = (ClampMin = "1", ClampMax = "16"))
+    int32 DebugOverlayStride = 1;
+
+    // Lift above the surface (cm) so the overlay doesn't z-fight the terrain
+    UPROPERTY(EditAnywhere, Category = "Terrain|Debug", meta = (ClampMin = "0.0"))
+    float DebugOverlayLift = 15.f;
+
+    UPROPERTY(EditAnywhere, Category = "Terrain|Debug", meta = (ClampMin = "1.0", ClampMax = "45.0"))
+    float DebugSlopeBandDeg = 10.f;
+
+    UPROPERTY(EditAnywhere, Category = "Terrain|Debug", meta = (ClampMin = "1.0"))
+    float DebugHeightBandSize = 500.f;
+
+    // NavigationCost: steeper than this is blocked
+    UPROPERTY(EditAnywhere, Category = "Terrain|Debug", meta = (ClampMin = "1.0", ClampMax = "90.0"))
+    float DebugNavMaxSlopeDeg = 40.f;
+
+    // Unlit vertex-color material; the engine's VertexColorMaterial if unset
     UPROPERTY(EditAnywhere, Category = "Terrain|Debug")
-    bool bDebugDrawNormals = true;
+    UMaterialInterface* DebugOverlayMaterial = nullptr;
 
-    UPROPERTY(EditAnywhere, Category = "Terrain|Debug", meta = (ClampMin = "10", UIMin = "10"))
-    float DebugNormalLength = 300.f;
+    UFUNCTION(BlueprintCallable, Category = "Terrain|Debug")
+    void SetDebugOverlay(ETerrainDebugOverlay Mode);
 
-    void DebugDrawNormals(const TArray<FVector>& Vertices,
-        const TArray<FVector>& Normals);
+    UFUNCTION(CallInEditor, Category = "Terrain|Debug")
+    void RefreshDebugOverlay();
+
+    // Heatmap for the ScatterRejections overlay (AScatterSpawner pushes its latest one)
+    void SetScatterRejections(const FScatterRejectionMap& Rejections);
 
 
     UPROPERTY(EditAnywhere, Category = "Terrain|Flatten")
@@ -127,6 +323,9 @@ public:
     UPROPERTY(EditAnywhere, Category = "Terrain|Water", meta = (ClampMin = "0.0"))
     float WaterZOffset = 0.5f;               // tiny lift to avoid coplanar z-fight at shores
 
+    UPROPERTY(EditAnywhere, Category = "Terrain|Water")
+    bool bTrimWaterToBodies = true;          // only cover cells of actual lakes instead of the whole map
+
     UPROPERTY(EditAnywhere, Category = "Terrain|Water")
     UMaterialInterface* WaterMaterial = nullptr;
 
@@ -137,6 +336,157 @@ public:
     UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Terrain|Query")
     FVector GetNormalAtWorldXY(float WorldX, float WorldY, bool bClampToBounds = true) const;
 
+    // Segment vs. the full-resolution height grid; independent of physics collision
+    UFUNCTION(BlueprintCallable, Category = "Terrain|Query")
+    bool RaycastTerrain(const FVector& WorldStart, const FVector& WorldEnd, FVector& OutHitLocation, FVector& OutHitNormal) const;
+
+    // Signed distance (cm) to the nearest WaterZ shoreline: negative under water, positive on land
+    UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Terrain|Query")
+    float GetShoreDistanceAtWorldXY(float WorldX, float WorldY) const;
+
+    // Connected water body under this point, or -1 on land
+    UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Terrain|Query")
+    int32 GetWaterBodyAtWorldXY(float WorldX, float WorldY) const;
+
+    UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Terrain|Query")
+    int32 GetNumWaterBodies() const { return WaterMap.GetNumBodies(); }
+
+    const FTerrainWaterMap& GetWaterMap() const { return WaterMap; }
+
+    // Summed-area tables for the footprint queries below, rebuilt with the grid
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Terrain|Query")
+    bool bBuildFootprintTables = true;
+
+    // Also keep a slope table (fills MeanSlopeDeg)
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Terrain|Query", meta = (EditCondition = "bBuildFootprintTables"))
+    bool bFootprintSlopeTable = true;
+
+    // Min/max/mean/variance of the grid heights (actor space, like GetHeightAtWorldXY) under an
+    // axis-aligned footprint; HalfExtent is in actor-local cm. Constant time.
+    UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Terrain|Query")
+    FTerrainFootprintStats GetFootprintStats(FVector WorldCenter, FVector2D HalfExtent) const;
+
+    // GetFootprintStats for many candidate spots sharing one footprint size
+    UFUNCTION(BlueprintCallable, Category = "Terrain|Query")
+    void GetFootprintStatsBatch(const TArray<FVector>& WorldCenters, FVector2D HalfExtent, TArray<FTerrainFootprintStats>& OutStats) const;
+
+    const FTerrainFootprintTables& GetFootprintTables() const { return FootprintTables; }
+
+    /**
+     * Grid vertices visible from an eye ObserverHeight above the terrain at WorldObserver, within
+     * Radius (cm). TargetHeight lifts the targets (e.g. enemy chest height). Reuse OutViewshed
+     * across calls to avoid reallocating. Returns false if the observer is off the grid.
+     */
+    bool ComputeViewshed(const FVector& WorldObserver, float ObserverHeight, float Radius,
+        FTerrainViewshed& OutViewshed, float TargetHeight = 0.f) const;
+
+    bool IsVisibleInViewshed(const FTerrainViewshed& Viewshed, float WorldX, float WorldY) const;
+
+    // Share (0..1) of the terrain within Radius visible from the spot; for build-preview UI
+    UFUNCTION(BlueprintCallable, Category = "Terrain|Query")
+    float GetViewshedCoverage(FVector WorldObserver, float ObserverHeight, float Radius, float TargetHeight = 0.f) const;
+
+    // ---- Spawn zones ----
+    // Horde spawn cells near the map edge, rebuilt with the grid: walkable, above water and
+    // connected over walkable ground to the flatten center (the map center without a pad),
+    // split into angular sectors around it. Deformation doesn't update them.
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Terrain|Spawn")
+    bool bBuildSpawnZones = true;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Terrain|Spawn", meta = (EditCondition = "bBuildSpawnZones", ClampMin = "1", UIMin = "1", UIMax = "32"))
+    int32 NumSpawnZones = 8;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Terrain|Spawn", meta = (EditCondition = "bBuildSpawnZones", ClampMin = "0.0", ClampMax = "90.0"))
+    float SpawnMaxSlopeDeg = 35.f;
+
+    // Spawn ground is at least this far above WaterZ (cm)
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Terrain|Spawn", meta = (EditCondition = "bBuildSpawnZones"))
+    float SpawnWaterClearance = 50.f;
+
+    // Width (cm) of the perimeter band spawn cells come from; <= 0 uses the whole map
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Terrain|Spawn", meta = (EditCondition = "bBuildSpawnZones"))
+    float SpawnEdgeBand = 4000.f;
+
+    // No spawn cell is closer than this (cm) to the flatten center
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Terrain|Spawn", meta = (EditCondition = "bBuildSpawnZones", ClampMin = "0.0"))
+    float SpawnMinBaseDistance = 6000.f;
+
+    UFUNCTION(BlueprintPure, Category = "Terrain|Spawn")
+    int32 GetNumSpawnZones() const { return SpawnZones.GetNumZones(); }
+
+    // Cells in a zone, or in all zones for -1
+    UFUNCTION(BlueprintPure, Category = "Terrain|Spawn")
+    int32 GetSpawnZoneCellCount(int32 Zone) const { return SpawnZones.GetZoneCellCount(Zone); }
+
+    // Uniform ground point in a zone (any zone for -1), world space; false if the zone is empty
+    UFUNCTION(BlueprintCallable, Category = "Terrain|Spawn")
+    bool GetRandomSpawnLocation(int32 Zone, UPARAM(ref) FRandomStream& Stream, FVector& OutLocation) const;
+
+    // Terrain-local cells, for drawing many points at once (AHordeCrowd::SpawnAgentsInZone)
+    const FTerrainSpawnZones& GetSpawnZones() const { return SpawnZones; }
+
+    // ---- Deformation ----
+    // Heights change immediately (queries see them at once); normals, GPU vertices and collision
+    // follow tile by tile within this per-frame budget. FullMesh collision switches to CoarseTiles
+    // on the first edit (until the next build), since a whole-terrain re-cook can't be budgeted;
+    // the old surface keeps colliding until every tile is in, so deformed maps want CoarseTiles.
+    // Edits are ignored while a staged build is in progress.
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Terrain|Deformation", meta = (ClampMin = "0.1", UIMin = "0.1", UIMax = "8.0"))
+    float DeformationBudgetMs = 1.f;
+
+    // Bowl-shaped crater, Depth cm deep at the center (Radius in actor-local cm)
+    UFUNCTION(BlueprintCallable, Category = "Terrain|Deformation")
+    void ApplyCrater(FVector WorldCenter, float Radius, float Depth);
+
+    // Levels a disc to TargetWorldZ, blending back to the terrain over Falloff cm
+    UFUNCTION(BlueprintCallable, Category = "Terrain|Deformation")
+    void FlattenTerrain(FVector WorldCenter, float Radius, float TargetWorldZ, float Falloff = 100.f);
+
+    UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Terrain|Deformation")
+    bool HasPendingDeformation() const;
+
+    // Heights were edited since the last build (GetGenerationHash no longer describes them)
+    bool HasDeformedHeights() const { return bHeightsDeformed; }
+
+    // Bumped by every height edit (and by a rebuild that drops edits), never reset, so caches keyed on it see each change
+    uint32 GetHeightEditRevision() const { return HeightEditRevision; }
+
+    // Generic edit: Edit(DistanceFromCenter, Height) -> new height for every vertex within Radius
+    void ApplyRadialHeightEdit(const FVector& WorldCenter, float Radius, TFunctionRef<float(float Dist, float Height)> Edit);
+
+    // Latest published terrain; safe to call from any thread and to query off the game thread.
+    // Null until the first build. Game-thread height queries above read the live cache instead.
+    FTerrainSnapshotPtr GetSnapshot() const;
+
+    // Game thread: GetSnapshot, after publishing any edits still waiting to settle
+    FTerrainSnapshotPtr GetUpToDateSnapshot();
+
+    // The snapshot the staged build in progress will publish; complete once ComputeStagedBuild returns
+    FTerrainSnapshotPtr GetStagedSnapshot() const { return Staged.Snapshot; }
+
+    // Version of the latest published snapshot (0 = none yet)
+    uint64 GetSnapshotVersion() const;
+
+    // Hash of every parameter that affects HeightCache (keys the on-disk height cache)
+    uint64 GetGenerationHash() const;
+
+    // World-grid index of our vertex (0,0); zero in index noise space
+    FIntPoint GetNoiseGridOrigin() const { return NoiseGridOrigin; }
+
+    // BuildMesh in three parts, for AMatchGenerationPipeline: Begin on the game thread, Compute on
+    // any one thread (heights, erosion, water map, normals, mesh data), then CommitStagedBuild on
+    // the game thread until it returns true. Compute fills staging buffers only, so queries keep
+    // answering from the previous build until the first commit step swaps the new one in; height
+    // edits are ignored until the commit finishes.
+    void BeginStagedBuild();
+    void ComputeStagedBuild();
+    bool CommitStagedBuild(double DeadlineSeconds);
+
+    bool IsStagedBuildInProgress() const { return Staged.CommitStep < FStagedTerrainBuild::NumCommitSteps; }
+
+
+    virtual void Tick(float DeltaSeconds) override;
+    virtual bool ShouldTickIfViewportsOnly() const override { return true; }
 
 protected:
     virtual void OnConstruction(const FTransform& Transform) override;
@@ -144,23 +494,119 @@ protected:
 private:
     void BuildMesh();
 
-    void GenerateGrid(
-        TArray<FVector>& OutVertices,
-        TArray<int32>& OutTriangles,
-        TArray<FVector>& OutNormals,
-        TArray<FVector2D>& OutUVs,
-        TArray<FProcMeshTangent>& OutTangents
-    );
+    // Progressive editor preview (bProgressivePreview); BeginStagedBuild cancels it
+    bool ShouldPreviewProgressively() const;
+    void BeginProgressivePreview();
+    void AdvanceProgressivePreview();
+    // Coarse surface straight from the noise into TerrainMesh; nothing the full build publishes is touched
+    void BuildPreviewPass(int32 Stride);
+
+    // Heights, water map, mesh arrays, footprint tables and spawn zones, all into Out
+    struct FStagedTerrainBuild;
+    void GenerateGrid(FStagedTerrainBuild& Out);
+
+    // Per-vertex blend weights from heights, normals, the water map and the flatten pad (see bBakeBlendWeights).
+    // Normals and OutColors are row-major over the inclusive vertex Rect.
+    void BakeBlendWeights(const TArray<float>& Heights, const FTerrainWaterMap& Water, const FIntRect& Rect,
+        const FVector* Normals, FColor* OutColors) const;
+
+    // Blend property ramps, hoisted out of the per-vertex loops
+    struct FBlendWeightRamps
+    {
+        float CosSlopeStart;
+        float InvSlopeRange;
+        float InvHeightRange;
+        float InvShoreWidth;
+    };
+    FBlendWeightRamps GetBlendWeightRamps() const;
+    // Shore is the 0..1 water weight (0 without water)
+    FColor BlendWeightsAt(const FBlendWeightRamps& Ramps, float NormalZ, float Height, float Shore, float Pad) const;
+
+    // Area-weighted normal of a grid vertex (same triangles as GenerateGrid); Heights is HeightCache
+    // or the staged build's grid
+    FVector GridNormalAt(const TArray<float>& Heights, int32 X, int32 Y) const;
+    void ComputeGridNormals(const TArray<float>& Heights, TArray<FVector>& OutNormals) const;
+
+    // Fills Heights: noise + flatten, then optional erosion (or a disk-cache hit)
+    void BuildHeightCache(TArray<float>& Heights, int32 VertsX, int32 VertsY);
+
+    // World noise: erodes Heights grown by WorldErosionApron, then fades erosion out at the edges
+    void ErodeWithApron(TArray<float>& Heights, int32 VertsX, int32 VertsY);
+
+    // Snaps our corner to the world grid for NoiseSpace World (warns when the actor isn't aligned)
+    void UpdateNoiseGridOrigin();
+    FIntPoint NoiseGridOrigin = FIntPoint::ZeroValue;
+
+    FString GetHeightCachePath(uint64 Hash) const;
+    bool LoadCachedHeights(uint64 Hash, TArray<float>& Heights, int32 VertsX, int32 VertsY);
+    void SaveCachedHeights(uint64 Hash, const TArray<float>& Heights, int32 VertsX, int32 VertsY);
+
+    // Tiles touching CookFirstRect (inclusive vertices) go to the front of the cook queue
+    void BuildCollisionTiles(const FIntRect* CookFirstRect = nullptr);
+    void ClearCollisionTiles();
+
+    // Retires finished cooks and submits queued tiles up to MaxConcurrentCollisionCooks
+    void PumpCollisionCooking();
+    void SubmitCollisionTile(int32 TileIndex);
+    bool IsCollisionTileCooked(int32 TileIndex);
+    void MarkCollisionTileReady(int32 TileIndex);
+    bool HasPendingCollisionCooks() const;
+
+    // Heights + normals packed for TerrainMesh (any thread), then handed over (game thread)
+    void BuildCompactMeshData(const TArray<float>& Heights, const TArray<FVector>& Normals, const TArray<FColor>& Colors,
+        FTerrainMeshData& Data) const;
+    // Swaps Data into TerrainMesh; Data comes back holding the previous build's buffers
+    void CommitCompactMesh(FTerrainMeshData& Data);
+
+    // Deformation: dirty-tile bookkeeping and the budgeted catch-up that runs from Tick
+    void QueueDeformedRegion(const FIntRect& EditRect);
+    void ProcessDeformation();
+    void RefreshDeformedTile(int32 TileIndex);
+    void UpdateProcMeshFromCache(const FIntRect& Rect);
+    void ResetDeformation();
+
+    // FullMesh collision under deformation: tiles are cooked for the whole grid, the edited ones
+    // first, then section 0's collision is dropped once they are all in, so there is never a gap
+    void BeginTiledDeformCollision(const FIntRect& EditRect);
+    bool HasFullMeshCollision() const;
+    void DropFullMeshCollision();
+
+    // Copies HeightCache + layout into a new immutable snapshot and swaps it in
+    void PublishSnapshot();
+    // The edits' snapshot (and the overlay drawn from it), ahead of the settle delay if need be
+    void PublishDeformedSnapshot();
+
+    // Game thread: the spare snapshot if nobody still holds it, else a new one
+    TSharedPtr<FTerrainSnapshot, ESPMode::ThreadSafe> AllocSnapshot();
+    // Any thread: copies a height grid, its water map and our layout, and reserves the next version
+    void FillSnapshot(FTerrainSnapshot& Out, const TArray<float>& Heights, const FTerrainWaterMap& Water);
+    // Game thread: makes New the current snapshot
+    void SwapInSnapshot(const TSharedPtr<FTerrainSnapshot, ESPMode::ThreadSafe>& New);
+
+    // New generator per seed, so nothing ever sees one reseeded underneath it
+    void ResetNoise();
+    void QueueCollisionRecook(int32 TileIndex);
 
     void BuildSlabSection();
     void BuildWaterSection();
+    void BuildTrimmedWaterSection();
+
+    // World XY -> fractional vertex-grid coordinates, clamped to the grid
+    void WorldToGrid(float WorldX, float WorldY, float& OutU, float& OutV) const;
+
+    // Inclusive vertex rectangle inside a footprint (nearest vertex if it covers none)
+    void FootprintToGridRect(const FVector& WorldCenter, const FVector2D& HalfExtent, int32& OutX0, int32& OutY0, int32& OutX1, int32& OutY1) const;
 
     // Continuous evaluator in *local/actor* XY (bilinear over index-space samples)
     float HeightAtLocalXY(float LocalX, float LocalY, bool bClampToBounds = true) const;
 
-    // Fast per-vertex sample at integer grid indices (uses your index-space noise and flatten)
+    // Fast per-vertex sample at integer grid indices (noise in NoiseSpace, then flatten); indices may
+    // lie outside the grid
     float SampleHeightAtIndex(int32 ix, int32 iy, float LocalX, float LocalY) const;
 
+    // 1 inside the flatten rectangle, 0 outside the falloff band (0 everywhere when disabled)
+    float FlattenWeightAtLocalXY(float LocalX, float LocalY) const;
+
     static FORCEINLINE float Smoothstep01(float t)
     {
         t = FMath::Clamp(t, 0.f, 1.f);
@@ -172,7 +618,141 @@ private:
 
     FORCEINLINE int32 CacheIndex(int32 X, int32 Y, int32 VertsX) const { return Y * VertsX + X; }
 
+    // Lakes + shore distance, built with the heights on every BuildMesh
+    FTerrainWaterMap WaterMap;
+
+    // Footprint statistics, built from the heights (and normals) in GenerateGrid
+    FTerrainFootprintTables FootprintTables;
+
+    // Horde spawn cells, built from the heights and normals in GenerateGrid
+    FTerrainSpawnZones SpawnZones;
+
+    // Staged build outputs, carried from ComputeStagedBuild to the commit steps. The first step swaps
+    // the grid and its derived data with the live members, so these keep the previous build's buffers.
+    struct FStagedTerrainBuild
+    {
+        static constexpr int32 NumCommitSteps = 4;
+
+        TArray<float> Heights;
+        FTerrainWaterMap WaterMap;
+        FTerrainFootprintTables FootprintTables;
+        FTerrainSpawnZones SpawnZones;
+
+        TArray<FVector> Vertices;
+        TArray<int32> Triangles;
+        TArray<FVector> Normals;
+        TArray<FVector2D> UVs;
+        TArray<FProcMeshTangent> Tangents;
+        TArray<FColor> Colors;
+        FTerrainMeshData MeshData;
+
+        // Taken in BeginStagedBuild, filled by ComputeStagedBuild, published by the last commit step
+        TSharedPtr<FTerrainSnapshot, ESPMode::ThreadSafe> Snapshot;
+
+        // NumCommitSteps when no build is in progress
+        int32 CommitStep = NumCommitSteps;
+
+        SIZE_T GetAllocatedSize() const;
+        void Empty();
+    };
+    FStagedTerrainBuild Staged;
+
+    // Scratch for the game-thread build steps, erosion and the height cache file
+    struct FBuildScratch
+    {
+        TArray<FVector> Vertices;
+        TArray<int32> Indices;
+        TArray<FVector> Normals;
+        TArray<FVector2D> UVs;
+        TArray<FProcMeshTangent> Tangents;
+        TArray<FColor> Colors;
+
+        // Collision tiles
+        TArray<int32> LinesX;
+        TArray<int32> LinesY;
+        TArray<float> TileDist2;
+
+        // Trimmed water: wet cells and greedy rectangles (cells [Min, Max))
+        TArray<uint8> WetCells;
+        TArray<FIntRect> WaterRects;
+        TArray<FIntRect> OpenRects;
+        TArray<FIntRect> NextOpenRects;
+
+        TArray<uint8> FileBytes;
+        FTerrainErosionScratch Erosion;
+
+        // Heights grown by WorldErosionApron
+        TArray<float> ApronHeights;
+
+        SIZE_T GetAllocatedSize() const;
+        void Empty();
+    };
+    FBuildScratch Scratch;
+
+    int64 PeakGenerationMemoryBytes = 0;
+    void UpdatePeakGenerationMemory();
+
+    FScatterRejectionMap ScatterRejections;
+
+    // Overlay build target; swapped with DebugOverlayMesh's data so both keep their capacity
+    FTerrainMeshData DebugOverlayData;
+
+    // Stride of the preview pass on screen; 0 once the full build is in (or none was started)
+    int32 PreviewPassStride = 0;
+    double PreviewEditTime = 0.0;
+
+    // Preview pass target, swapped with TerrainMesh's data like Staged.MeshData
+    FTerrainMeshData PreviewMeshData;
+
+    // Collision-only components for ETerrainCollisionMode::CoarseTiles (row-major tiles)
+    UPROPERTY(Transient)
+    TArray<UProceduralMeshComponent*> CollisionTiles;
+
+    int32 CollisionTilesX = 0;
+    int32 CollisionTilesY = 0;
+    int32 NumCollisionTilesReady = 0;
+    TArray<bool> CollisionTileReady;
+
+    // Tiles in cook order, and how far we are through it
+    TArray<int32> CollisionCookQueue;
+    int32 CollisionCookCursor = 0;
+    TArray<int32> CollisionCooking;
+
+    // Body setup each tile had when its cook was submitted; a different, cooked one means done
+    TArray<TWeakObjectPtr<UBodySetup>> CollisionTileSubmittedOver;
+
+    // Set when a tile is edited while its cook is in flight; it is queued again once that lands
+    TArray<bool> CollisionTileDirty;
+
+    // Per render tile, the inclusive vertex rect still to refresh (empty when Max < Min)
+    TArray<FIntRect> DeformDirtyRects;
+    TArray<int32> DeformTileQueue;
+    int32 DeformTileCursor = 0;
+
+    // Follow-ups over the union of the edits, deferred until they settle
+    bool bDeformProcMeshDirty = false;
+    bool bDeformFootprintDirty = false;
+    bool bDeformSnapshotDirty = false;
+    bool bHeightsDeformed = false;
+    double LastDeformEditTime = 0.0;
+    uint32 HeightEditRevision = 0;
+
+    // Vertices whose height or normal changed since FootprintTables / the ProcMesh section last caught up
+    FIntRect DeformFootprintRect = FIntRect(0, 0, -1, -1);
+    FIntRect DeformProcMeshRect = FIntRect(0, 0, -1, -1);
+
+    // FullMesh collision replaced by tiles for deformation; cleared by the next build
+    bool bDeformCollisionTiled = false;
+
 
     // Seedable Perlin noise (header-only helper)
-    FPerlinNoise* NoisePtr = nullptr;
+    TSharedPtr<FPerlinNoise, ESPMode::ThreadSafe> NoisePtr;
+
+    // Current snapshot; swapped under the lock, never modified after publish
+    FTerrainSnapshotPtr Snapshot;
+    uint64 SnapshotVersion = 0;
+    mutable FRWLock SnapshotLock;
+
+    // The snapshot retired by the last publish; refilled by the next one if nobody still holds it
+    TSharedPtr<FTerrainSnapshot, ESPMode::ThreadSafe> SpareSnapshot;
 };
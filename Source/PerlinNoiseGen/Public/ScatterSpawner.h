@@ -3,9 +3,12 @@
 #include "CoreMinimal.h"
 #include "Math/RandomStream.h"   // add this near the top
 #include "GameFramework/Actor.h"
+#include "TerrainDebugOverlay.h"
+#include "TerrainSnapshot.h"
 #include "ScatterSpawner.generated.h"
 
 class ANoiseTerrainActor;
+class FTerrainHorizonOcclusion;
 
 USTRUCT(BlueprintType)
 struct FSpawnRequest
@@ -58,6 +61,16 @@ struct FSpawnRequest
     UPROPERTY(EditAnywhere, Category = "Constraints")
     bool bDisallowBelowWater = false;
 
+    // Optional window on the terrain's signed shore distance (cm, negative = under water)
+    UPROPERTY(EditAnywhere, Category = "Constraints|Shore")
+    bool bUseShoreDistance = false;
+
+    UPROPERTY(EditAnywhere, Category = "Constraints|Shore", meta = (EditCondition = "bUseShoreDistance"))
+    float MinShoreDistance = 0.f;
+
+    UPROPERTY(EditAnywhere, Category = "Constraints|Shore", meta = (EditCondition = "bUseShoreDistance"))
+    float MaxShoreDistance = 500.f;
+
     // Keep spawns off the terrain's central platform (core only)
     UPROPERTY(EditAnywhere, Category = "Constraints|Flatten")
     bool bDisallowOnFlattenCore = false;
@@ -67,6 +80,11 @@ struct FSpawnRequest
     UPROPERTY(EditAnywhere, Category = "Constraints|Flatten", meta = (ClampMin = "0.0"))
     float FlattenCoreExtra = 0.f;
 
+    // Stable identity: seeds placement and keeps built state with the request when the list is
+    // reordered. Assigned by the spawner when missing or duplicated.
+    UPROPERTY(VisibleAnywhere, Category = "Advanced")
+    FGuid Id;
+
 
 
 
@@ -102,25 +120,209 @@ public:
     UPROPERTY(EditAnywhere, Category = "Spawn")
     TArray<FSpawnRequest> Requests;
 
+    // Edge of the square scatter tiles (cm, terrain-local). Each tile of each request has its own
+    // random stream, so any of them can be regenerated without disturbing the rest.
+    UPROPERTY(EditAnywhere, Category = "Random", meta = (ClampMin = "500.0"))
+    float ScatterTileSize = 5000.f;
+
+    // Re-transform and reuse existing actors of the same class on regenerate; only the
+    // difference is spawned or destroyed
+    UPROPERTY(EditAnywhere, Category = "Spawn")
+    bool bPoolActors = true;
+
+    // Reuse placements from Saved/ScatterCache when seed, requests and terrain all match
+    UPROPERTY(EditAnywhere, Category = "Cache")
+    bool bCacheResults = true;
+
+    // Regenerates only requests whose settings changed (everything if seed/region/terrain did)
     UFUNCTION(CallInEditor, Category = "Spawn")
     void Generate();
 
+    // Generate in three parts, for AMatchGenerationPipeline: Begin on the game thread (false if
+    // there is nothing to scatter on), Compute on any one thread against a terrain snapshot (the
+    // terrain's staged one while it is still building), then CommitStagedGenerate on the game
+    // thread until it returns true
+    bool BeginStagedGenerate();
+    void ComputeStagedGenerate(FTerrainSnapshotPtr Ground);
+    bool CommitStagedGenerate(double DeadlineSeconds);
+
+    // 0..1 through the commit of the current staged generate
+    float GetStagedProgress() const;
+
+    // Re-scatters one request even if its settings are unchanged
+    UFUNCTION(BlueprintCallable, Category = "Spawn")
+    void RegenerateRequest(int32 RequestIndex);
+
+    // Re-scatters the tiles of every request overlapping a terrain-local rectangle (e.g. after an edit)
+    UFUNCTION(BlueprintCallable, Category = "Spawn")
+    void RegenerateRegion(FVector2D LocalMin, FVector2D LocalMax);
+
     UFUNCTION(CallInEditor, Category = "Spawn")
     void ClearSpawned();
 
+    // Bucket size (cm) of the instance index behind the Remove/Query calls below
+    UPROPERTY(EditAnywhere, Category = "Runtime", meta = (ClampMin = "100.0"))
+    float IndexCellSize = 1000.f;
+
+    // Removes every instance within Radius (horizontal) of WorldCenter, e.g. under a new turret.
+    // Removed instances stay gone until their tile is regenerated. Returns how many were removed.
+    UFUNCTION(BlueprintCallable, Category = "Runtime")
+    int32 RemoveInstancesInRadius(FVector WorldCenter, float Radius);
+
+    // Same for a terrain-aligned rectangle of HalfExtent (cm) around WorldCenter
+    UFUNCTION(BlueprintCallable, Category = "Runtime")
+    int32 RemoveInstancesInFootprint(FVector WorldCenter, FVector2D HalfExtent);
+
+    // Spawned actors within Radius of WorldCenter, without removing them
+    UFUNCTION(BlueprintCallable, Category = "Runtime")
+    int32 QueryInstancesInRadius(FVector WorldCenter, float Radius, TArray<AActor*>& OutActors) const;
+
+    // Hides spawned actors the terrain hides from Occlusion's eye (InstanceHeight cm tall) and shows
+    // the rest; only actors whose state changes are touched. Null shows everything. Returns how many
+    // are hidden.
+    int32 ApplyOcclusion(const FTerrainHorizonOcclusion* Occlusion, float InstanceHeight);
+
     UPROPERTY(VisibleAnywhere, Transient, Category = "Runtime")
     AActor* SpawnContainer = nullptr;
 
+    // Count rejected placement attempts per cell and reason, and hand them to the terrain's
+    // ScatterRejections overlay. Covers the requests each generate recomputes; cached
+    // placements are not reused while this is on.
+    UPROPERTY(EditAnywhere, Category = "Debug")
+    bool bRecordRejections = false;
+
+    UPROPERTY(EditAnywhere, Category = "Debug", meta = (ClampMin = "50.0", EditCondition = "bRecordRejections"))
+    float RejectionCellSize = 500.f;
+
+    const FScatterRejectionMap& GetRejections() const { return Rejections; }
+
     AActor* EnsureSpawnContainer(); // helper to create/reuse container
 
 protected:
     virtual void OnConstruction(const FTransform& Xform) override;
 
 private:
-    UPROPERTY(Transient)
-    TArray<TWeakObjectPtr<AActor>> SpawnedActors;
+    struct FScatterTile
+    {
+        TArray<FTransform> Placements;          // world space
+        TArray<TWeakObjectPtr<AActor>> Actors;  // per placement (null if removed)
+        TBitArray<> Removed;                    // per placement, cleared on regenerate
+        TBitArray<> Occluded;                   // per placement, hidden by ApplyOcclusion
+        TArray<int32> IndexBuckets;             // per placement, its IndexCells bucket (INDEX_NONE if none)
+    };
+
+    struct FScatterRequestState
+    {
+        FGuid Id;                               // FSpawnRequest::Id this state belongs to
+        uint64 SettingsHash = 0;                // HashRequest at build time (0 = not built)
+        TArray<FScatterTile> Tiles;
+    };
+
+    // Per request (same order as Requests, matched up by Id in BeginStagedGenerate)
+    TArray<FScatterRequestState> RequestStates;
+
+    // GetLayoutHash the states were built against
+    uint64 LayoutHash = 0;
+
+    // Terrain GetHeightEditRevision the states were placed on (or RegenerateRegion caught up to)
+    uint32 SeenHeightEditRevision = 0;
+
+    // Scatter rectangle (terrain-local) and its tiling, from UpdateLayout
+    FVector2D ScatterMin = FVector2D::ZeroVector;
+    FVector2D ScatterMax = FVector2D::ZeroVector;
+    int32 ScatterTilesX = 1;
+    int32 ScatterTilesY = 1;
+
+    void UpdateLayout();
+    // Gives every request a unique Id, deterministic per spawner and slot
+    void AssignRequestIds();
+    // RequestStates lines up with Requests one to one
+    bool AreRequestStatesCurrent() const;
+    int32 GetTileQuota(const FSpawnRequest& R, int32 TileIndex) const;
+    // Placement reads only Ground, never the live terrain; OutRejections (optional) receives every failed attempt
+    void ComputeTile(const FTerrainSnapshot& Ground, int32 RequestIndex, int32 TileIndex, TArray<FTransform>& Out,
+        FScatterRejectionMap* OutRejections) const;
+    void RebuildRequest(const FTerrainSnapshot& Ground, int32 RequestIndex);
+    // Terrain's current snapshot, or null (with a warning) before it has heights
+    FTerrainSnapshotPtr GetGround() const;
+    void SpawnTile(int32 RequestIndex, int32 TileIndex);
+    void ReleaseTile(int32 RequestIndex, int32 TileIndex);
+    void ReleaseRequest(int32 RequestIndex);
+    void ReleaseAll();
+
+    // ---- Instance index ----
+    // Uniform grid over the scatter rectangle; each live placement is in exactly one bucket
+    struct FScatterInstanceRef
+    {
+        FVector2f LocalXY;                      // terrain-local
+        int32 Request = 0;
+        int32 Tile = 0;
+        int32 Slot = 0;
+    };
+
+    TArray<TArray<FScatterInstanceRef>> IndexCells;
+    FVector2D IndexOrigin = FVector2D::ZeroVector;
+    float IndexCellExtent = 1000.f;
+    int32 IndexCellsX = 0;
+    int32 IndexCellsY = 0;
+
+    void ResetInstanceIndex();
+    FIntPoint GetIndexCoord(const FVector2f& LocalXY) const;
+    void IndexTile(int32 RequestIndex, int32 TileIndex);
+    void UnindexTile(int32 RequestIndex, int32 TileIndex);
+    void UnindexSlot(int32 RequestIndex, int32 TileIndex, int32 Slot);
+
+    // Guards readers of IndexCells: the ref's slot still exists in its tile's arrays
+    bool IsLiveRef(const FScatterInstanceRef& Ref) const
+    {
+        return RequestStates.IsValidIndex(Ref.Request) && RequestStates[Ref.Request].Tiles.IsValidIndex(Ref.Tile)
+            && RequestStates[Ref.Request].Tiles[Ref.Tile].IndexBuckets.IsValidIndex(Ref.Slot);
+    }
+
+    // (Request, Tile, Slot) of live instances in the buckets over [LocalMin, LocalMax] passing Inside
+    void GatherInstances(const FVector2f& LocalMin, const FVector2f& LocalMax,
+        TFunctionRef<bool(const FVector2f& LocalXY)> Inside, TArray<FIntVector>& OutRefs) const;
+    int32 RemoveGathered(const TArray<FIntVector>& Refs);
+
+    // ---- Actor pool ----
+    // Pooled actor of Class moved to T, or a deferred spawn finished by CommitSpawns
+    AActor* AcquireActor(UClass* Class, const FTransform& T);
+    void ReleaseActor(AActor* A);
+
+    // Finishes deferred spawns and attaches them to the container in one pass (resumable;
+    // false if the deadline hit first)
+    bool CommitSpawns(double DeadlineSeconds = DBL_MAX);
+
+    // Destroys released actors that weren't reused
+    void FlushPool();
+
+    // Released actors by class, alive until the end of the current Generate/Regenerate
+    TMap<UClass*, TArray<TWeakObjectPtr<AActor>>> ActorPool;
+    TArray<TPair<AActor*, FTransform>> PendingSpawns;
+    int32 PendingSpawnCursor = 0;
+
+    // Staged generate: requests to place / to spawn, and progress through the spawn tiles
+    TArray<int32> StagedCompute;
+    TArray<int32> StagedSpawn;
+    int32 StagedSpawnCursor = 0;
+    bool bStagedUseDiskCache = false;
+
+    // Rejected attempts of the latest generate (empty unless bRecordRejections)
+    FScatterRejectionMap Rejections;
+    void ResetRejections();
+    void PublishRejections();
+    FScatterRejectionMap* GetRejectionSink() { return bRecordRejections ? &Rejections : nullptr; }
+
+    // ---- Hashing / scatter cache ----
+    uint64 GetLayoutHash() const;
+    static uint64 HashRequest(const FSpawnRequest& R);
+    uint64 GetScatterHash() const;
+    FString GetScatterCachePath(uint64 Hash) const;
+    bool LoadScatterCache(uint64 Hash);
+    void SaveScatterCache(uint64 Hash) const;
 
     bool PickRandomXY(FRandomStream& RNG, float& OutX, float& OutY) const;
-    bool AcceptByConstraints(const FSpawnRequest& R, float X, float Y, float& OutZ, FVector& OutNormal) const;
+    bool AcceptByConstraints(const FTerrainSnapshot& Ground, const FSpawnRequest& R, float X, float Y, float& OutZ, FVector& OutNormal,
+        EScatterRejectReason& OutReason) const;
     bool RespectSpacing(const FSpawnRequest& R, float X, float Y, const TArray<FVector2D>& Placed2D) const;
 };
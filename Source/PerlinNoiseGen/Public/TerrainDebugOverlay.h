@@ -0,0 +1,92 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "TerrainDebugOverlay.generated.h"
+
+class FTerrainSnapshot;
+struct FTerrainMeshData;
+
+UENUM(BlueprintType)
+enum class ETerrainDebugOverlay : uint8
+{
+    None,
+    // Surface normal as RGB (each axis mapped from -1..1)
+    Normals,
+    // Bands of DebugSlopeBandDeg, green (flat) to red (steep)
+    Slope,
+    // Bands of DebugHeightBandSize, blue (lowest) to red (highest); darker under water
+    Height,
+    // Rejected scatter attempts per cell, tinted by the most common reason
+    ScatterRejections,
+    // Cost of walking over the ground: green (flat) to red, black where blocked (too steep or under water)
+    NavigationCost
+};
+
+UENUM(BlueprintType)
+enum class EScatterRejectReason : uint8
+{
+    FlattenCore,
+    Height,
+    Water,
+    Shore,
+    Slope,
+    Spacing,
+    Count UMETA(Hidden)
+};
+
+/** Rejected placement attempts per cell and reason, in terrain-local XY. Add is thread-safe. */
+struct PERLINNOISEGEN_API FScatterRejectionMap
+{
+    static constexpr int32 NumReasons = (int32)EScatterRejectReason::Count;
+
+    FVector2f Origin = FVector2f::ZeroVector;
+    float CellSize = 500.f;
+    int32 CellsX = 0;
+    int32 CellsY = 0;
+
+    // Counts[Cell * NumReasons + Reason]
+    TArray<int32> Counts;
+
+    void Init(const FVector2f& Min, const FVector2f& Max, float InCellSize);
+    void Reset();
+
+    bool IsValid() const { return CellsX > 0 && Counts.Num() == CellsX * CellsY * NumReasons; }
+
+    // Points outside the map are dropped
+    void Add(float LocalX, float LocalY, EScatterRejectReason Reason);
+
+    // Total of the cell under (LocalX, LocalY), and its most common reason
+    int32 Sample(float LocalX, float LocalY, EScatterRejectReason& OutDominant) const;
+
+    int32 GetMaxCellTotal() const;
+};
+
+struct FTerrainDebugOverlaySettings
+{
+    ETerrainDebugOverlay Mode = ETerrainDebugOverlay::None;
+
+    // Every Stride-th grid vertex becomes an overlay vertex
+    int32 Stride = 1;
+    int32 TileQuads = 64;
+
+    float SlopeBandDeg = 10.f;
+    float HeightBandSize = 500.f;
+    float NavMaxSlopeDeg = 40.f;
+};
+
+/**
+ * Heightfield debug views as one vertex-colored mesh: a single parallel pass over the snapshot's
+ * grid fills heights, normals and the mode's colors, ready for a UTerrainMeshComponent drawn with
+ * an unlit vertex-color material. Replaces per-sample debug lines.
+ */
+class PERLINNOISEGEN_API FTerrainDebugOverlay
+{
+public:
+    // Out is laid out like FTerrainMeshData for the terrain, at GridSpacing * Stride; with a
+    // stride that doesn't divide the grid the last row/column overhangs the far edge. Out's arrays
+    // are refilled in place, so reusing one Out across builds doesn't reallocate
+    static void Build(const FTerrainSnapshot& Ground, const FTerrainDebugOverlaySettings& Settings,
+        const FScatterRejectionMap* Rejections, FTerrainMeshData& Out);
+
+    static FLinearColor GetReasonColor(EScatterRejectReason Reason);
+};
@@ -0,0 +1,93 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "TerrainErosion.generated.h"
+
+USTRUCT(BlueprintType)
+struct FTerrainErosionSettings
+{
+    GENERATED_BODY()
+
+    // Fixed iteration budget: each pass is one hydraulic sweep followed by thermal relaxation
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Erosion", meta = (ClampMin = "1", UIMin = "1", UIMax = "64"))
+    int32 Iterations = 8;
+
+    // ---- Hydraulic (particle) ----
+    // Droplets released per grid cell on every pass (0.05 on 1024^2 = ~52k droplets per pass)
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Erosion|Hydraulic", meta = (ClampMin = "0.0", UIMax = "1.0"))
+    float DropletsPerCell = 0.05f;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Erosion|Hydraulic", meta = (ClampMin = "1", UIMin = "1", UIMax = "64"))
+    int32 DropletLifetime = 30;
+
+    // 0 = droplets follow the gradient exactly, 1 = they never turn
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Erosion|Hydraulic", meta = (ClampMin = "0.0", ClampMax = "1.0"))
+    float Inertia = 0.05f;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Erosion|Hydraulic", meta = (ClampMin = "0.0"))
+    float SedimentCapacity = 4.f;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Erosion|Hydraulic", meta = (ClampMin = "0.0"))
+    float MinSedimentCapacity = 0.01f;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Erosion|Hydraulic", meta = (ClampMin = "0.0", ClampMax = "1.0"))
+    float ErodeSpeed = 0.3f;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Erosion|Hydraulic", meta = (ClampMin = "0.0", ClampMax = "1.0"))
+    float DepositSpeed = 0.3f;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Erosion|Hydraulic", meta = (ClampMin = "0.0", ClampMax = "1.0"))
+    float EvaporateSpeed = 0.02f;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Erosion|Hydraulic", meta = (ClampMin = "0.0"))
+    float Gravity = 4.f;
+
+    // Brush radius (cells) used when a droplet removes material
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Erosion|Hydraulic", meta = (ClampMin = "1", ClampMax = "6"))
+    int32 BrushRadius = 2;
+
+    // ---- Thermal (grid) ----
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Erosion|Thermal", meta = (ClampMin = "0", UIMax = "16"))
+    int32 ThermalStepsPerIteration = 2;
+
+    // Slopes steeper than this shed material downhill
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Erosion|Thermal", meta = (ClampMin = "1.0", ClampMax = "89.0"))
+    float TalusAngleDeg = 38.f;
+
+    // Fraction of the excess over the talus slope moved per step
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Erosion|Thermal", meta = (ClampMin = "0.0", ClampMax = "0.5"))
+    float ThermalRate = 0.25f;
+};
+
+/** Full-grid buffers Erode needs besides the heights; keep one around to erode without allocating. */
+struct FTerrainErosionScratch
+{
+    TArray<float> Thermal;
+    TArray<float> Scale;
+
+    SIZE_T GetAllocatedSize() const { return Thermal.GetAllocatedSize() + Scale.GetAllocatedSize(); }
+};
+
+/**
+ * Hydraulic (droplet) + thermal erosion over a row-major (VertsX * VertsY) height grid.
+ * Work is split into cache-sized tiles that run in parallel; every tile draws from its
+ * own seeded stream, so the result depends only on Seed and the settings, never on
+ * thread count or scheduling.
+ */
+class PERLINNOISEGEN_API FTerrainErosion
+{
+public:
+    static void Erode(TArray<float>& Heights, int32 VertsX, int32 VertsY, float GridSpacing,
+        int32 Seed, const FTerrainErosionSettings& Settings);
+
+    // Same, with caller-owned scratch (Heights and Scratch.Thermal may trade buffers)
+    static void Erode(TArray<float>& Heights, int32 VertsX, int32 VertsY, float GridSpacing,
+        int32 Seed, const FTerrainErosionSettings& Settings, FTerrainErosionScratch& Scratch);
+
+private:
+    static void HydraulicPass(float* Heights, int32 VertsX, int32 VertsY, int32 Seed, int32 Pass,
+        const FTerrainErosionSettings& Settings);
+
+    static void ThermalStep(const float* Src, float* Dst, float* Scale, int32 VertsX, int32 VertsY,
+        float Talus, float Rate);
+};
@@ -0,0 +1,97 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "TerrainFootprintTables.generated.h"
+
+/** Height statistics under a footprint, as returned by ANoiseTerrainActor::GetFootprintStats. */
+USTRUCT(BlueprintType)
+struct FTerrainFootprintStats
+{
+    GENERATED_BODY()
+
+    // False if the footprint missed the grid or the tables are not built
+    UPROPERTY(BlueprintReadOnly, Category = "Terrain|Query")
+    bool bValid = false;
+
+    // Grid vertices covered
+    UPROPERTY(BlueprintReadOnly, Category = "Terrain|Query")
+    int32 NumSamples = 0;
+
+    UPROPERTY(BlueprintReadOnly, Category = "Terrain|Query")
+    float MinHeight = 0.f;
+
+    UPROPERTY(BlueprintReadOnly, Category = "Terrain|Query")
+    float MaxHeight = 0.f;
+
+    UPROPERTY(BlueprintReadOnly, Category = "Terrain|Query")
+    float MeanHeight = 0.f;
+
+    // cm^2; sqrt for the standard deviation
+    UPROPERTY(BlueprintReadOnly, Category = "Terrain|Query")
+    float HeightVariance = 0.f;
+
+    // Slope of the mean gradient, in degrees (-1 without the slope table)
+    UPROPERTY(BlueprintReadOnly, Category = "Terrain|Query")
+    float MeanSlopeDeg = -1.f;
+};
+
+/**
+ * Summed-area tables of height, height^2 and (optionally) slope over the vertex grid, plus a
+ * square min/max pyramid, for constant-time footprint statistics.
+ * Sums are O(1) for any rectangle; min/max cost ceil(W/S) * ceil(H/S) lookups with S the
+ * largest power-of-two square that fits, so 4 for near-square footprints.
+ */
+class PERLINNOISEGEN_API FTerrainFootprintTables
+{
+public:
+    // Normals (same layout as Heights) enable the slope table; pass nullptr to skip it
+    void Build(const TArray<float>& Heights, int32 InVertsX, int32 InVertsY, const TArray<FVector>* Normals);
+    void Reset();
+
+    // Catches the tables up with Heights edited inside the inclusive vertex Rect (within the grid).
+    // RectNormals is row-major over Rect and needed when HasSlope(). The pyramid is only touched near
+    // Rect; the sums below and right of it get one parallel add of the edit's delta.
+    void UpdateRect(const TArray<float>& Heights, const FIntRect& Rect, const TArray<FVector>* RectNormals);
+
+    bool IsValid() const { return VertsX > 0 && SumH.Num() == (VertsX + 1) * (VertsY + 1); }
+    bool HasSlope() const { return IsValid() && SumSlope.Num() == SumH.Num(); }
+
+    // Inclusive vertex rectangle, clamped to the grid
+    FTerrainFootprintStats Query(int32 X0, int32 Y0, int32 X1, int32 Y1) const;
+
+    SIZE_T GetAllocatedSize() const;
+
+    // Largest min/max square is 2^(MaxPyramidLevels - 1) vertices on a side
+    static constexpr int32 MaxPyramidLevels = 8;
+
+private:
+    void BuildTable(TArray<double>& Table, TFunctionRef<double(int32)> Value) const;
+    void BuildPyramid(const TArray<float>& Heights);
+
+    // Recomputes level k (from level k - 1) for the inclusive corner range, clamped to valid corners
+    void ReduceLevel(int32 k, int32 CX0, int32 CY0, int32 CX1, int32 CY1);
+
+    // Adds Change (per vertex of the inclusive rect) to Table, as if it had been built with it
+    void ApplyDelta(TArray<double>& Table, int32 X0, int32 Y0, int32 X1, int32 Y1, TFunctionRef<double(int32 X, int32 Y)> Change);
+
+    // tan(slope) = |N.xy| / N.z
+    static double GradientOf(const FVector& N) { return FMath::Sqrt(N.X * N.X + N.Y * N.Y) / FMath::Max(N.Z, 1.e-3); }
+
+    double RectSum(const TArray<double>& Table, int32 X0, int32 Y0, int32 X1, int32 Y1) const;
+    void RectMinMax(int32 X0, int32 Y0, int32 X1, int32 Y1, float& OutMin, float& OutMax) const;
+
+    int32 VertsX = 0;
+    int32 VertsY = 0;
+
+    // (VertsX + 1) * (VertsY + 1), first row and column zero
+    TArray<double> SumH;
+    TArray<double> SumH2;
+    TArray<double> SumSlope;    // gradient magnitude (rise / run)
+
+    // Level k: min/max over the 2^k square whose corner is each vertex (VertsX * VertsY each)
+    TArray<TArray<float>> MinLevels;
+    TArray<TArray<float>> MaxLevels;
+
+    // UpdateRect's prefix sums of the change, kept between edits
+    TArray<double> DeltaScratch;
+};
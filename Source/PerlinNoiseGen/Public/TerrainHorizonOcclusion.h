@@ -0,0 +1,87 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "TerrainSnapshot.h"
+
+/**
+ * Conservative terrain occlusion from one eye, in terrain-local space. The grid is split into
+ * tiles with their min/max heights; Update sweeps the tiles front to back and keeps, per
+ * azimuth bin, the steepest elevation that nearer terrain is guaranteed to block (from each
+ * tile's minimum height). Every tile records the horizon in front of it, so a point in the tile
+ * is occluded when its top is below that elevation. Misses some occlusion, never invents it.
+ */
+class PERLINNOISEGEN_API FTerrainHorizonOcclusion
+{
+public:
+    // Per-tile height ranges; needed again only when the snapshot changes
+    void BuildTiles(const FTerrainSnapshotRef& InGround, int32 InTileQuads);
+    void Reset();
+
+    // Horizon sweep from LocalEye; cost is a sort of the tiles plus their azimuth spans
+    void Update(const FVector& LocalEye, int32 NumBins);
+
+    bool IsValid() const { return Ground.IsValid() && TileMinZ.Num() > 0 && TileHorizon.Num() == TileMinZ.Num(); }
+
+    const FTerrainSnapshotPtr& GetGround() const { return Ground; }
+    const FVector& GetEye() const { return Eye; }
+
+    // True if terrain hides LocalTop (the highest point of whatever stands there) from the eye
+    FORCEINLINE bool IsPointOccluded(float LocalX, float LocalY, float TopZ) const
+    {
+        const int32 Tile = GetTileAt(LocalX, LocalY);
+        if (Tile == INDEX_NONE) return false;
+
+        const float Dist = FMath::Sqrt(FMath::Square(LocalX - (float)Eye.X) + FMath::Square(LocalY - (float)Eye.Y));
+        return Dist > MinOccludeeDistance && (TopZ - (float)Eye.Z) < TileHorizon[Tile] * Dist;
+    }
+
+    // Same for something HeightAboveGround tall anywhere in the tile under LocalXY
+    FORCEINLINE bool IsColumnOccluded(float LocalX, float LocalY, float HeightAboveGround) const
+    {
+        const int32 Tile = GetTileAt(LocalX, LocalY);
+        return Tile != INDEX_NONE && IsPointOccluded(LocalX, LocalY, TileMaxZ[Tile] + HeightAboveGround);
+    }
+
+    FORCEINLINE int32 GetTileAt(float LocalX, float LocalY) const
+    {
+        const int32 tx = FMath::FloorToInt((LocalX - Origin.X) / TileExtent);
+        const int32 ty = FMath::FloorToInt((LocalY - Origin.Y) / TileExtent);
+        return (tx >= 0 && ty >= 0 && tx < TilesX && ty < TilesY) ? ty * TilesX + tx : INDEX_NONE;
+    }
+
+    // Share of tiles whose highest point plus HeightAboveGround is hidden
+    float GetOccludedTileFraction(float HeightAboveGround) const;
+
+    // Closer than this (cm) nothing is culled
+    static constexpr float MinOccludeeDistance = 100.f;
+
+private:
+    FTerrainSnapshotPtr Ground;
+
+    int32 TilesX = 0;
+    int32 TilesY = 0;
+    float TileExtent = 800.f;
+    FVector2f Origin = FVector2f::ZeroVector;
+
+    TArray<float> TileMinZ;
+    TArray<float> TileMaxZ;
+
+    // Elevation slope (dz / horizontal distance) of the horizon in front of each tile: the lowest
+    // over the bins the tile overlaps. -FLT_MAX where nothing is in front.
+    TArray<float> TileHorizon;
+
+    FVector Eye = FVector::ZeroVector;
+
+    // Sweep scratch, kept between updates
+    struct FOccluder
+    {
+        float FarDist;
+        float Slope;
+        int32 FirstBin;     // fully covered bins, inclusive, may wrap
+        int32 NumBins;
+    };
+    TArray<float> Horizon;
+    TArray<int32> TileOrder;
+    TArray<float> TileNearDist;
+    TArray<FOccluder> Pending;
+};
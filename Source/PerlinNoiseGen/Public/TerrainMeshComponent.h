@@ -0,0 +1,108 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/MeshComponent.h"
+#include "PackedNormal.h"
+#include "TerrainMeshComponent.generated.h"
+
+/** One render tile: a contiguous vertex range addressed with 16-bit local indices. */
+struct FTerrainMeshTile
+{
+    int32 QuadX0 = 0;       // first quad column/row covered
+    int32 QuadY0 = 0;
+    int32 QuadsX = 0;       // quads covered
+    int32 QuadsY = 0;
+
+    int32 BaseVertex = 0;   // first vertex of this tile in the vertex buffer
+    int32 FirstIndex = 0;   // into the shared index patterns
+    int32 NumTriangles = 0;
+
+    int32 NumVertices() const { return (QuadsX + 1) * (QuadsY + 1); }
+};
+
+/**
+ * CPU-side terrain mesh, stored as the height grid itself: XY and UVs are reconstructed from the
+ * grid layout at upload, normals are packed, there is no tangent array (+X projected on the
+ * normal is derived on upload) and colors are optional.
+ */
+struct PERLINNOISEGEN_API FTerrainMeshData
+{
+    int32 NumQuadsX = 0;
+    int32 NumQuadsY = 0;
+    float GridSpacing = 100.f;
+
+    // Quads per tile side; (TileQuads + 1)^2 must fit 16-bit indices
+    int32 TileQuads = 64;
+
+    TArray<float> Heights;          // (NumQuadsX + 1) * (NumQuadsY + 1), row-major
+    TArray<FPackedNormal> Normals;  // same layout
+    TArray<FColor> Colors;          // same layout, or empty
+
+    FBox LocalBounds = FBox(ForceInit);
+
+    static constexpr int32 MaxTileQuads = 254; // 255^2 vertices < 65536
+
+    bool IsValid() const { return NumQuadsX > 0 && NumQuadsY > 0 && Heights.Num() == (NumQuadsX + 1) * (NumQuadsY + 1); }
+
+    int32 GetVertsX() const { return NumQuadsX + 1; }
+    int32 GetTilesX() const { return FMath::DivideAndRoundUp(NumQuadsX, GetTileQuads()); }
+    int32 GetTilesY() const { return FMath::DivideAndRoundUp(NumQuadsY, GetTileQuads()); }
+    int32 GetTileQuads() const { return FMath::Clamp(TileQuads, 1, MaxTileQuads); }
+
+    // Inclusive vertex range of a tile (row-major tile index); neighbours share their border line
+    FIntRect GetTileVertexRect(int32 TileIndex) const;
+
+    FVector3f GetLocalPosition(int32 X, int32 Y) const;
+    FVector2f GetUV(int32 X, int32 Y) const;
+
+    void RecomputeBounds();
+
+    /**
+     * Tile table plus the 16-bit index patterns they draw with. Tiles of the same size share a
+     * pattern, so at most four patterns exist (interior, right edge, bottom edge, corner).
+     */
+    void BuildLayout(TArray<FTerrainMeshTile>& OutTiles, TArray<uint32>& OutIndices, int32& OutNumVertices) const;
+
+    SIZE_T GetAllocatedSize() const { return Heights.GetAllocatedSize() + Normals.GetAllocatedSize() + Colors.GetAllocatedSize(); }
+};
+
+/**
+ * Terrain-specific mesh component: float positions, packed tangent frame, half-precision UVs,
+ * optional colors, 16-bit per-tile indices in cache-friendly stripe order, drawn as static
+ * mesh batches (one per tile).
+ */
+UCLASS(ClassGroup = Rendering, meta = (BlueprintSpawnableComponent))
+class PERLINNOISEGEN_API UTerrainMeshComponent : public UMeshComponent
+{
+    GENERATED_BODY()
+
+public:
+    UTerrainMeshComponent(const FObjectInitializer& ObjectInitializer);
+
+    void SetMeshData(FTerrainMeshData&& InData);
+
+    // Same, handing the previous data back so its buffers can be refilled for the next build
+    void SwapMeshData(FTerrainMeshData& InOutData);
+    void ClearMeshData();
+
+    const FTerrainMeshData& GetMeshData() const { return MeshData; }
+
+    // For in-place edits (heights, normals, colors); follow with CommitTile for every tile touched
+    FTerrainMeshData& GetMutableMeshData() { return MeshData; }
+
+    // Re-uploads one tile's vertices in place (no proxy rebuild) and grows the bounds to fit
+    void CommitTile(int32 TileIndex);
+
+    // GPU bytes the current data occupies once uploaded (vertex + index buffers)
+    SIZE_T GetGPUMemoryBytes() const;
+
+    //~ UPrimitiveComponent
+    virtual FPrimitiveSceneProxy* CreateSceneProxy() override;
+    virtual int32 GetNumMaterials() const override { return 1; }
+
+    //~ USceneComponent
+    virtual FBoxSphereBounds CalcBounds(const FTransform& LocalToWorld) const override;
+
+private:
+    FTerrainMeshData MeshData;
+};
@@ -0,0 +1,87 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "TerrainHorizonOcclusion.h"
+#include "TerrainOcclusionCuller.generated.h"
+
+class ANoiseTerrainActor;
+class AScatterSpawner;
+class AHordeCrowd;
+
+/**
+ * Culls scatter actors and crowd agents hidden behind the terrain from the player's camera,
+ * before they reach the renderer (the engine's occlusion queries don't see the heightfield).
+ * The horizon is re-swept when the camera has moved RecomputeDistance or the terrain
+ * republishes; scatter visibility is only touched where it changes, crowds read the result
+ * in their own instance update.
+ */
+UCLASS()
+class PERLINNOISEGEN_API ATerrainOcclusionCuller : public AActor
+{
+    GENERATED_BODY()
+
+public:
+    ATerrainOcclusionCuller();
+
+    UPROPERTY(EditAnywhere, Category = "Occlusion")
+    ANoiseTerrainActor* Terrain = nullptr;
+
+    // Spawners and crowds on Terrain (others are skipped)
+    UPROPERTY(EditAnywhere, Category = "Occlusion")
+    TArray<AScatterSpawner*> Scatterers;
+
+    UPROPERTY(EditAnywhere, Category = "Occlusion")
+    TArray<AHordeCrowd*> Crowds;
+
+    UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Occlusion")
+    bool bCullingEnabled = true;
+
+    // Horizon tile edge in terrain quads; smaller tiles occlude more, sweeps cost more
+    UPROPERTY(EditAnywhere, Category = "Occlusion", meta = (ClampMin = "2", UIMin = "2", UIMax = "64"))
+    int32 TileQuads = 8;
+
+    UPROPERTY(EditAnywhere, Category = "Occlusion", meta = (ClampMin = "16", UIMin = "64", UIMax = "4096"))
+    int32 NumAzimuthBins = 1024;
+
+    // Camera travel (cm) before the horizon is swept again
+    UPROPERTY(EditAnywhere, Category = "Occlusion", meta = (ClampMin = "0.0"))
+    float RecomputeDistance = 100.f;
+
+    // Height (cm) of the tallest scatter actor above the ground, e.g. the tallest tree
+    UPROPERTY(EditAnywhere, Category = "Occlusion", meta = (ClampMin = "0.0"))
+    float ScatterInstanceHeight = 1500.f;
+
+    // Off shows everything again
+    UFUNCTION(BlueprintCallable, Category = "Occlusion")
+    void SetCullingEnabled(bool bEnabled);
+
+    // Share of horizon tiles hidden for ScatterInstanceHeight, as of the last sweep
+    UFUNCTION(BlueprintPure, Category = "Occlusion")
+    float GetOccludedTileFraction() const;
+
+    UFUNCTION(BlueprintPure, Category = "Occlusion")
+    int32 GetNumHiddenScatterInstances() const { return NumHiddenScatter; }
+
+    virtual void Tick(float DeltaSeconds) override;
+
+protected:
+    virtual void BeginPlay() override;
+    virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+private:
+    // Sweeps from Eye (world space) and pushes the result to the scatterers
+    void UpdateOcclusion(const FVector& Eye);
+
+    // Shows everything and detaches the crowds
+    void ClearOcclusion();
+
+    bool IsOnTerrain(const AActor* Other, const ANoiseTerrainActor* OtherTerrain) const;
+
+    // Shared with the crowds, which read it during their tick
+    TSharedRef<FTerrainHorizonOcclusion, ESPMode::ThreadSafe> Occlusion;
+
+    FVector LastEye = FVector(FLT_MAX);
+    uint64 LastGroundVersion = 0;
+    int32 NumHiddenScatter = 0;
+};
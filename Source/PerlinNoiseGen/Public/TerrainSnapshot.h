@@ -0,0 +1,63 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Immutable copy of everything a height query needs: the height grid, its layout, the actor
+ * transform, shore distances and the flatten pad. Published by ANoiseTerrainActor as a shared const reference;
+ * any thread may hold one and query it while the actor rebuilds and publishes the next version.
+ */
+class PERLINNOISEGEN_API FTerrainSnapshot
+{
+public:
+    // Increases with every publish from the same actor
+    uint64 Version = 0;
+
+    int32 NumQuadsX = 0;
+    int32 NumQuadsY = 0;
+    float GridSpacing = 100.f;
+    FTransform ActorTransform = FTransform::Identity;
+
+    // (NumQuadsX + 1) * (NumQuadsY + 1), row-major, actor-local Z
+    TArray<float> Heights;
+
+    // Signed distance to the WaterZ shoreline (cm, negative under water), laid out like Heights;
+    // empty when the terrain has no water map
+    TArray<float> ShoreDistance;
+
+    float WaterZ = 0.f;
+
+    bool bEnableFlatten = false;
+    FVector2D FlattenCenter = FVector2D::ZeroVector;
+    FVector2D FlattenSize = FVector2D::ZeroVector;
+    float FlattenHeight = 0.f;
+    float FlattenFalloff = 1.f;
+
+    bool IsValid() const { return NumQuadsX > 0 && NumQuadsY > 0 && Heights.Num() == (NumQuadsX + 1) * (NumQuadsY + 1); }
+
+    // Bilinear over the grid, actor-local XY/Z; outside the grid clamps (or returns 0)
+    float GetHeightAtLocalXY(float LocalX, float LocalY, bool bClampToBounds = true) const;
+
+    // Same space as ANoiseTerrainActor::GetHeightAtWorldXY (actor-local Z)
+    float GetHeightAtWorldXY(float WorldX, float WorldY, bool bClampToBounds = true) const;
+    // World-space, facing up; sampled one cell apart in actor-local space
+    FVector GetNormalAtWorldXY(float WorldX, float WorldY, bool bClampToBounds = true) const;
+
+    // 1 inside the flatten rectangle, 0 outside its falloff band
+    float GetFlattenWeightAtLocalXY(float LocalX, float LocalY) const;
+
+    bool IsUnderWaterAtWorldXY(float WorldX, float WorldY) const { return GetHeightAtWorldXY(WorldX, WorldY) < WaterZ; }
+
+    // Same as ANoiseTerrainActor::GetShoreDistanceAtWorldXY (FTerrainWaterMap::NoShoreDistance without water)
+    float GetShoreDistanceAtWorldXY(float WorldX, float WorldY) const;
+
+    // True if the segment (actor-local) stays above the terrain, sampled every half cell
+    bool HasLineOfSightLocal(const FVector& From, const FVector& To) const;
+
+private:
+    // Bilinear over a per-vertex grid; U/V are fractional vertex coordinates inside [0, NumQuads]
+    float SampleGrid(const TArray<float>& Values, float U, float V) const;
+};
+
+using FTerrainSnapshotRef = TSharedRef<const FTerrainSnapshot, ESPMode::ThreadSafe>;
+using FTerrainSnapshotPtr = TSharedPtr<const FTerrainSnapshot, ESPMode::ThreadSafe>;
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+struct FTerrainSpawnZoneSettings
+{
+    // Steepest ground an agent may stand on
+    float MaxSlopeDeg = 35.f;
+
+    // Ground must be this far above WaterZ (cm)
+    float WaterClearance = 50.f;
+
+    // Cells within this distance (cm) of the grid edge; <= 0 takes the whole map
+    float EdgeBand = 4000.f;
+
+    // Cells closer than this (cm) to the base are never used
+    float MinBaseDistance = 6000.f;
+
+    // Angular sectors around the base
+    int32 NumZones = 8;
+};
+
+/**
+ * Precomputed spawn cells for waves: grid quads whose four corners are walkable (slope, above
+ * water) and connected to the base over walkable ground, inside the perimeter band. Cells are
+ * stored as one quad index per cell, grouped by angular sector around the base, so a draw is
+ * one random index plus a random point inside the quad. Positions are terrain-local.
+ */
+class PERLINNOISEGEN_API FTerrainSpawnZones
+{
+public:
+    // Normals in the same layout as Heights; BaseLocalXY is the point agents must be able to reach
+    void Build(const TArray<float>& Heights, const TArray<FVector>& Normals, int32 InNumQuadsX, int32 InNumQuadsY,
+        float InGridSpacing, float WaterZ, const FVector2D& BaseLocalXY, const FTerrainSpawnZoneSettings& Settings);
+    void Reset();
+
+    bool IsValid() const { return NumQuadsX > 0 && ZoneStart.Num() > 1; }
+
+    int32 GetNumZones() const { return FMath::Max(ZoneStart.Num() - 1, 0); }
+    int32 GetNumCells() const { return Cells.Num(); }
+
+    // Cells in one zone, or in all of them for INDEX_NONE
+    int32 GetZoneCellCount(int32 Zone) const;
+
+    // Mean terrain-local XY of a zone's cells (zero when empty)
+    FVector2f GetZoneCentroid(int32 Zone) const { return ZoneCentroids.IsValidIndex(Zone) ? ZoneCentroids[Zone] : FVector2f::ZeroVector; }
+
+    // Uniform point over the zone's cells (any zone for INDEX_NONE); false if the zone is empty
+    bool Draw(int32 Zone, FRandomStream& Stream, FVector2f& OutLocalXY) const;
+
+    // Results plus the build scratch, which is kept so rebuilds at the same size don't allocate
+    SIZE_T GetAllocatedSize() const;
+
+private:
+    // Marks Reachable: 4-connected flood over walkable vertices from the one nearest the base
+    void FloodFromBase(const FVector2D& BaseLocalXY);
+
+    int32 NumQuadsX = 0;
+    int32 NumQuadsY = 0;
+    float GridSpacing = 100.f;
+
+    // Quad indices (y * NumQuadsX + x), zone by zone; zone z is [ZoneStart[z], ZoneStart[z + 1])
+    TArray<int32> Cells;
+    TArray<int32> ZoneStart;
+    TArray<FVector2f> ZoneCentroids;
+
+    // Build scratch, per vertex
+    TArray<uint8> Walkable;
+    TArray<uint8> Reachable;
+    TArray<int32> FloodQueue;
+    TArray<int32> CellZones;
+};
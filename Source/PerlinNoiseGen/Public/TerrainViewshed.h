@@ -0,0 +1,55 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Visible-vertex set of a height grid from one observer, by horizon propagation (XDraw):
+ * rings are swept outward and each vertex carries the steepest line-of-sight slope seen so far,
+ * interpolated from the two vertices of the previous ring that bracket its ray.
+ * One pass, O(cells within the radius); the scratch buffers are kept between calls so repeated
+ * evaluation (build-preview dragging) does not allocate.
+ */
+class PERLINNOISEGEN_API FTerrainViewshed
+{
+public:
+    /**
+     * Observer at vertex (ObserverX, ObserverY) with eye height ObserverZ (same space as Heights).
+     * A vertex is visible if a point TargetHeight above it can be seen. RadiusCells is in vertices.
+     */
+    void Compute(const TArray<float>& Heights, int32 VertsX, int32 VertsY,
+        int32 ObserverX, int32 ObserverY, float ObserverZ, float TargetHeight, float RadiusCells);
+
+    void Reset();
+
+    bool IsValid() const { return Visible.Num() > 0; }
+
+    // Inclusive vertex bounds the mask covers
+    const FIntRect& GetRect() const { return Rect; }
+
+    // Grid vertex coordinates; false outside the rect or radius
+    bool IsVisible(int32 X, int32 Y) const
+    {
+        if (X < Rect.Min.X || Y < Rect.Min.Y || X > Rect.Max.X || Y > Rect.Max.Y) return false;
+        return Visible[(Y - Rect.Min.Y) * RectWidth + (X - Rect.Min.X)];
+    }
+
+    // Row-major over GetRect()
+    const TBitArray<>& GetMask() const { return Visible; }
+
+    int32 GetNumVisible() const { return NumVisible; }
+
+    // Vertices within the radius (visible or not)
+    int32 GetNumCells() const { return NumCells; }
+
+private:
+    FIntRect Rect;
+    int32 RectWidth = 0;
+
+    TBitArray<> Visible;
+
+    // Steepest observer-to-terrain slope along the ray to each vertex (height per cell)
+    TArray<float> Horizon;
+
+    int32 NumVisible = 0;
+    int32 NumCells = 0;
+};
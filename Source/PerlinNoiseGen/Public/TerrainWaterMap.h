@@ -0,0 +1,63 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Connected below-water regions of a height grid plus a signed distance-to-shore field.
+ * Bodies are 4-connected vertex flood fills under WaterZ; the distance field is an exact
+ * Euclidean transform (Felzenszwalb-Huttenlocher), linear in the number of vertices.
+ * Distances are in cm: negative under water, positive on land.
+ */
+class PERLINNOISEGEN_API FTerrainWaterMap
+{
+public:
+    void Build(const TArray<float>& Heights, int32 InVertsX, int32 InVertsY, float GridSpacing, float WaterZ);
+    void Reset();
+
+    bool IsValid() const { return VertsX > 0 && BodyIds.Num() == VertsX * VertsY; }
+
+    int32 GetVertsX() const { return VertsX; }
+    int32 GetVertsY() const { return VertsY; }
+
+    // INDEX_NONE on land
+    FORCEINLINE int32 GetBodyAt(int32 X, int32 Y) const { return BodyIds[Y * VertsX + X]; }
+    FORCEINLINE float GetShoreDistanceAt(int32 X, int32 Y) const { return ShoreDistance[Y * VertsX + X]; }
+
+    // Row-major over the vertex grid, for copying out whole
+    const TArray<float>& GetShoreDistances() const { return ShoreDistance; }
+
+    // Bilinear over the vertex grid; U/V are fractional grid coordinates
+    float SampleShoreDistance(float U, float V) const;
+
+    int32 GetNumBodies() const { return BodyCellCounts.Num(); }
+    int32 GetBodyCellCount(int32 Body) const { return BodyCellCounts[Body]; }
+
+    // Inclusive vertex bounds of a body
+    const FIntRect& GetBodyBounds(int32 Body) const { return BodyBounds[Body]; }
+
+    // Returned where there is no water (or no land) anywhere on the grid
+    static constexpr float NoShoreDistance = 1.0e7f;
+
+    // Results plus the build scratch, which is kept so rebuilds at the same size don't allocate
+    SIZE_T GetAllocatedSize() const;
+
+private:
+    void FloodFillBodies(const TArray<float>& Heights, float WaterZ);
+    void BuildDistanceField(float GridSpacing);
+
+    int32 VertsX = 0;
+    int32 VertsY = 0;
+
+    TArray<int32> BodyIds;
+    TArray<float> ShoreDistance;
+
+    TArray<int32> BodyCellCounts;
+    TArray<FIntRect> BodyBounds;
+
+    // Build scratch
+    TArray<int32> FloodStack;
+    TArray<float> ToWater;
+    TArray<float> ToLand;
+    TArray<float> LineScratch;
+    TArray<int32> IndexScratch;
+};